@@ -0,0 +1,12 @@
+#!/bin/bash
+
+symex=../../../src/symex/symex
+
+options=$1
+name=${2%.c}
+cache=$name.cache
+
+# the first run fills the cache, which the second one reads
+rm -rf $cache
+$symex $name.c --query-cache $cache $options > /dev/null
+$symex $name.c --query-cache $cache $options
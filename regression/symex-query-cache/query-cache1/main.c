@@ -0,0 +1,16 @@
+int main()
+{
+  int x, y;
+
+  for(int i=0; i<3; i++)
+  {
+    if(x>i)
+      y=x-i;
+    else
+      y=i-x;
+
+    __CPROVER_assert(y>0, "positive");
+  }
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+int main()
+{
+  int a, b;
+  int x=0;
+
+  if(a>10)
+    x=1;
+  else if(a<-10)
+    x=2;
+
+  if(b==x)
+    x=3;
+
+  return x;
+}
@@ -0,0 +1,13 @@
+int main()
+{
+  int x, i;
+  int count=0;
+
+  for(i=0; i<10; i++)
+    if(x&(1<<i))
+      count++;
+
+  __CPROVER_assert(count!=10, "all bits");
+
+  return 0;
+}
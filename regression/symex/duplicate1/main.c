@@ -0,0 +1,20 @@
+int main()
+{
+  _Bool c;
+  int x, y;
+
+  if(c)
+    x=1;
+  else
+    x=1;
+
+  // the paths c,!c and !c,c end up in the same state
+  if(c)
+    y=1;
+  else
+    y=1;
+
+  __CPROVER_assert(x==y, "equal");
+
+  return 0;
+}
@@ -0,0 +1,19 @@
+int main()
+{
+  int x, y, z;
+  int r=0;
+
+  if(x)
+    r++;
+
+  if(y)
+    r++;
+
+  if(z)
+    r++;
+
+  __CPROVER_assert(r<=3, "bounded");
+  __CPROVER_assert(r!=3, "all taken");
+
+  return 0;
+}
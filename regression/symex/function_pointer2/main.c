@@ -0,0 +1,35 @@
+int g;
+
+void inc(void)
+{
+  g+=1;
+}
+
+void dbl(void)
+{
+  g*=2;
+}
+
+void neg(void)
+{
+  g=-g;
+}
+
+int main()
+{
+  int a, b, c, d;
+  void (*f)(void);
+
+  g=3;
+
+  f=a?inc:(b?dbl:neg);
+  f();
+
+  f=c?inc:(d?dbl:neg);
+  f();
+
+  __CPROVER_assert(g<=12, "at most 12");
+  __CPROVER_assert(g!=-6, "not negated and doubled");
+
+  return 0;
+}
@@ -0,0 +1,26 @@
+int sum;
+
+void add_one(int i)
+{
+  sum+=1;
+}
+
+void add_index(int i)
+{
+  sum+=i;
+}
+
+int main()
+{
+  int choice[3];
+
+  for(int i=0; i<3; i++)
+  {
+    void (*f)(int)=choice[i]?add_one:add_index;
+    f(i);
+  }
+
+  __CPROVER_assert(sum!=3, "not three");
+
+  return 0;
+}
@@ -0,0 +1,13 @@
+int main()
+{
+  int n, i;
+  int sum=0;
+
+  for(i=0; i<n; i++)
+    sum+=i;
+
+  if(n==2)
+    __CPROVER_assert(sum!=1, "sum");
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+int main()
+{
+  int a, b, c;
+  int x=0;
+
+  if(a)
+    x+=1;
+  else
+    x+=2;
+
+  if(b)
+    x+=10;
+  else
+    x+=20;
+
+  if(c)
+    x+=100;
+  else
+    x+=200;
+
+  __CPROVER_assert(x>=111 && x<=222, "in range");
+  __CPROVER_assert(x!=212, "not 212");
+
+  return 0;
+}
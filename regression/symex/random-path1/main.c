@@ -0,0 +1,17 @@
+int main()
+{
+  int x, n, i;
+
+  if(x)
+  {
+    // every iteration splits the path
+    for(i=0; i<n; i++)
+      ;
+
+    __CPROVER_assert(0, "deep");
+  }
+  else
+    __CPROVER_assert(0, "shallow");
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+int fac(int n)
+{
+  int result;
+
+  if(n <= 1)
+    return 1;
+
+  result = fac(n - 1);
+  __CPROVER_assert(result * n <= 24, "the callee's result");
+
+  return result * n;
+}
+
+int main()
+{
+  int r = fac(4);
+  __CPROVER_assert(r == 24, "return value of the outermost call");
+}
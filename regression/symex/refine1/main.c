@@ -0,0 +1,9 @@
+int main()
+{
+  unsigned a, b;
+
+  if(a>1 && b>1 && a<100 && b<100)
+    __CPROVER_assert(a*b!=143, "not a product of 11 and 13");
+
+  return 0;
+}
@@ -0,0 +1,17 @@
+int main()
+{
+  int x, i;
+
+  if(x)
+  {
+    // the locations of the loop are executed again and again
+    for(i=0; i<4; i++)
+      ;
+
+    __CPROVER_assert(0, "after the loop");
+  }
+  else
+    __CPROVER_assert(0, "straight");
+
+  return 0;
+}
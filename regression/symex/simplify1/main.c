@@ -0,0 +1,18 @@
+int main()
+{
+  int a, b, c;
+
+  b=a;
+  c=b;
+
+  if(c>5)
+  {
+    __CPROVER_assert(a>5, "copied");
+    __CPROVER_assert(a>6, "not copied");
+  }
+
+  if(a==3)
+    __CPROVER_assert(c==3, "constant");
+
+  return 0;
+}
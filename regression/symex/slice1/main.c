@@ -0,0 +1,17 @@
+int main()
+{
+  int a, b, i;
+  int x=0, y=0;
+
+  for(i=0; i<3; i++)
+    if(a>i)
+      x++;
+
+  if(b>0)
+    y=1;
+
+  __CPROVER_assert(y==0 || b>0, "y set on b");
+  __CPROVER_assert(x<3, "x below 3");
+
+  return 0;
+}
@@ -0,0 +1,9 @@
+int main()
+{
+  int x;
+
+  if(x>0)
+    __CPROVER_assert(x!=0, "positive");
+
+  return 0;
+}
@@ -0,0 +1,3 @@
+#!/bin/sh
+# a stand-in for an SMT2 solver that finds every problem unsatisfiable
+echo unsat
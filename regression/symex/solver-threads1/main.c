@@ -0,0 +1,19 @@
+int main()
+{
+  int x, y;
+  int r=0;
+
+  if(x>0)
+    r++;
+
+  if(x<0 && r==1)
+    r=100;
+
+  if(y==x)
+    r+=2;
+
+  __CPROVER_assert(r!=100, "unreachable");
+  __CPROVER_assert(r!=3, "both taken");
+
+  return 0;
+}
@@ -0,0 +1,9 @@
+int main()
+{
+  unsigned a, b;
+
+  if(a>1 && b>1 && a<1000 && b<1000)
+    __CPROVER_assert(a*b!=221, "not 13*17");
+
+  return 0;
+}
@@ -0,0 +1,12 @@
+int main()
+{
+  unsigned long long p, q;
+
+  __CPROVER_assume(p>1 && p<4294967296ull);
+  __CPROVER_assume(q>1 && q<4294967296ull);
+
+  // the product of the primes 2147483647 and 2147483629
+  __CPROVER_assert(p*q!=4611685975477714963ull, "not a product of primes");
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+int main()
+{
+  unsigned long long p, q;
+  int r=0;
+
+  __CPROVER_assume(p>1 && p<4294967296ull);
+  __CPROVER_assume(q>1 && q<4294967296ull);
+
+  // the product of the primes 2147483647 and 2147483629
+  if(p*q==4611685975477714963ull)
+    r=1;
+
+  __CPROVER_assert(r<=1, "bounded");
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+int main()
+{
+  unsigned char a[4];
+  int sum=0;
+
+  for(int i=0; i<4; i++)
+  {
+    if(a[i]>100)
+      sum+=2;
+    else
+      sum+=1;
+  }
+
+  __CPROVER_assert(sum>=4, "at least one per element");
+  __CPROVER_assert(sum!=8, "not all large");
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+int main()
+{
+  int x, y, z;
+
+  if(x)
+    __CPROVER_assert(0, "near");
+  else
+  {
+    y=z+1;
+    z=y*2;
+
+    __CPROVER_assert(z!=4, "target");
+  }
+
+  return 0;
+}
@@ -9,6 +9,8 @@ Author: Daniel Kroening, kroening@kroening.com
 /// \file
 /// Build Goto Trace from State History
 
+#include <algorithm>
+
 #include <util/simplify_expr.h>
 
 #include "build_goto_trace.h"
@@ -18,11 +20,35 @@ goto_tracet build_goto_trace(
   const path_symex_statet &state,
   const decision_proceduret &decision_procedure)
 {
-  // follow the history in the state,
-  // but in a forwards-fashion
+  return build_goto_trace(
+    state.history, state.config.ns, decision_procedure);
+}
+
+/// follow the history back from the given step to build a goto trace
+goto_tracet build_goto_trace(
+  path_symex_step_reft history,
+  const namespacet &ns,
+  const decision_proceduret &decision_procedure)
+{
+  // follow the history, but in a forwards-fashion
 
   std::vector<path_symex_step_reft> steps;
-  state.history.build_history(steps);
+
+  // Merged paths are expanded into the side that the model
+  // takes, as given by the merge guards.
+  for(path_symex_step_reft s=history; !s.is_nil(); --s)
+  {
+    while(s->is_merge())
+    {
+      const std::size_t side=
+        decision_procedure.get(s->merge->merge_guards[0]).is_true()?0:1;
+      s=s->merge->merged_paths[side];
+    }
+
+    steps.push_back(s);
+  }
+
+  std::reverse(steps.begin(), steps.end());
 
   goto_tracet goto_trace;
 
@@ -44,25 +70,25 @@ goto_tracet build_goto_trace(
     switch(instruction.type)
     {
     case ASSIGN:
-      if(step.lhs.type().id()==ID_array &&
-         step.ssa_rhs.id()==ID_with)
+      if(step.lhs().type().id()==ID_array &&
+         step.ssa_rhs().id()==ID_with)
       {
         // this is an unbounded array, assigned as
         //  new_array = old_array WITH [index:=value]
         //
         // instead process as
         //  new_array[index] = value
-        const exprt index_ssa=to_with_expr(step.ssa_rhs).where();
+        const exprt index_ssa=to_with_expr(step.ssa_rhs()).where();
         const exprt index_value=decision_procedure.get(index_ssa);
-        trace_step.full_lhs=index_exprt(step.lhs, index_value);
+        trace_step.full_lhs=index_exprt(step.lhs(), index_value);
         trace_step.full_lhs_value=
-          simplify_expr(decision_procedure.get(index_exprt(step.ssa_lhs, index_ssa)),
-                        state.config.ns);
+          simplify_expr(decision_procedure.get(index_exprt(step.ssa_lhs(), index_ssa)),
+                        ns);
       }
       else
       {
-        trace_step.full_lhs=step.lhs;
-        trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs);
+        trace_step.full_lhs=step.lhs();
+        trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs());
       }
 
       trace_step.type=goto_trace_stept::typet::ASSIGNMENT;
@@ -71,8 +97,8 @@ goto_tracet build_goto_trace(
 
     case DECL:
       trace_step.type=goto_trace_stept::typet::DECL;
-      trace_step.full_lhs=step.lhs;
-      trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs);
+      trace_step.full_lhs=step.lhs();
+      trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs());
       trace_step.assignment_type=goto_trace_stept::assignment_typet::STATE;
       break;
 
@@ -94,11 +120,11 @@ goto_tracet build_goto_trace(
 
     case FUNCTION_CALL:
       // these have parameter assignments!
-      if(step.lhs.is_not_nil())
+      if(step.lhs().is_not_nil())
       {
         trace_step.type=goto_trace_stept::typet::ASSIGNMENT;
-        trace_step.full_lhs=step.lhs;
-        trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs);
+        trace_step.full_lhs=step.lhs();
+        trace_step.full_lhs_value=decision_procedure.get(step.ssa_lhs());
         trace_step.assignment_type=
           goto_trace_stept::assignment_typet::ACTUAL_PARAMETER;
         // trace_step.lhs_object and trace_step.lhs_object_value
@@ -107,10 +133,10 @@ goto_tracet build_goto_trace(
       else
       {
         trace_step.type=goto_trace_stept::typet::FUNCTION_CALL;
-        trace_step.called_function=step.called_function;
-        trace_step.function_arguments.resize(step.function_arguments.size());
+        trace_step.called_function=step.called_function();
+        trace_step.function_arguments.resize(step.function_arguments().size());
         for(std::size_t i=0; i<trace_step.function_arguments.size(); i++)
-          trace_step.function_arguments[i]=decision_procedure.get(step.function_arguments[i].ssa_lhs);
+          trace_step.function_arguments[i]=decision_procedure.get(step.function_arguments()[i].ssa_lhs);
       }
       break;
 
@@ -22,4 +22,10 @@ goto_tracet build_goto_trace(
   const path_symex_statet &,
   const decision_proceduret &);
 
+// the trace of the path up to the given step
+goto_tracet build_goto_trace(
+  path_symex_step_reft history,
+  const namespacet &,
+  const decision_proceduret &);
+
 #endif // CPROVER_PATH_SYMEX_BUILD_GOTO_TRACE_H
@@ -0,0 +1,310 @@
+/*******************************************************************\
+
+Module: Copy-on-Write Containers for the States
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Copy-on-Write Containers for the States
+///
+/// A state is copied whenever the path forks, and most of its parts
+/// are left unchanged by both copies. The containers below are shared
+/// by the copies, and are copied only in parts, when they are written.
+
+#ifndef CPROVER_PATH_SYMEX_COPY_ON_WRITE_H
+#define CPROVER_PATH_SYMEX_COPY_ON_WRITE_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <util/invariant.h>
+
+/// A vector that is split into chunks of 'chunk_size' elements. Copies
+/// share the chunks, and the vector of the chunks. Writing an element
+/// copies its chunk, unless it is not shared. As with expanding_vectort,
+/// the non-const operator[] expands the vector as needed.
+template<typename T, std::size_t chunk_size=64>
+class cow_vectort
+{
+public:
+  typedef std::size_t size_type;
+  typedef T value_type;
+
+  cow_vectort():number_of_elements(0)
+  {
+  }
+
+  size_type size() const
+  {
+    return number_of_elements;
+  }
+
+  bool empty() const
+  {
+    return number_of_elements==0;
+  }
+
+  const T &operator[](size_type n) const
+  {
+    PRECONDITION(n<number_of_elements);
+    return (*(*chunks)[n/chunk_size])[n%chunk_size];
+  }
+
+  // warning: the reference is not stable
+  T &operator[](size_type n)
+  {
+    if(n>=number_of_elements)
+      resize(n+1);
+
+    return writable_chunk(n/chunk_size)[n%chunk_size];
+  }
+
+  const T &back() const
+  {
+    return (*this)[number_of_elements-1];
+  }
+
+  T &back()
+  {
+    PRECONDITION(number_of_elements!=0);
+    return (*this)[number_of_elements-1];
+  }
+
+  void push_back(const T &value)
+  {
+    resize(number_of_elements+1);
+    back()=value;
+  }
+
+  void pop_back()
+  {
+    PRECONDITION(number_of_elements!=0);
+
+    if((number_of_elements-1)%chunk_size==0)
+      writable_chunks().pop_back();
+    else
+      writable_chunk((number_of_elements-1)/chunk_size).pop_back();
+
+    number_of_elements--;
+  }
+
+  void resize(size_type new_size)
+  {
+    if(new_size==number_of_elements)
+      return;
+
+    chunkst &c=writable_chunks();
+    const size_type number_of_chunks=(new_size+chunk_size-1)/chunk_size;
+
+    c.resize(number_of_chunks);
+
+    for(size_type i=0; i<number_of_chunks; i++)
+    {
+      const size_type chunk_elements=
+        i+1<number_of_chunks?chunk_size:new_size-i*chunk_size;
+
+      if(c[i]==nullptr)
+      {
+        c[i]=std::make_shared<chunkt>();
+        c[i]->reserve(chunk_size);
+      }
+
+      if(c[i]->size()!=chunk_elements)
+        writable_chunk(i).resize(chunk_elements);
+    }
+
+    number_of_elements=new_size;
+  }
+
+  class const_iterator
+  {
+  public:
+    const_iterator(const cow_vectort &_vector, size_type _n):
+      vector(&_vector), n(_n)
+    {
+    }
+
+    const T &operator*() const
+    {
+      return (*vector)[n];
+    }
+
+    const T *operator->() const
+    {
+      return &(*vector)[n];
+    }
+
+    const_iterator &operator++()
+    {
+      n++;
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const
+    {
+      return n==other.n;
+    }
+
+    bool operator!=(const const_iterator &other) const
+    {
+      return n!=other.n;
+    }
+
+  protected:
+    const cow_vectort *vector;
+    size_type n;
+  };
+
+  const_iterator begin() const
+  {
+    return const_iterator(*this, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(*this, number_of_elements);
+  }
+
+  // The bytes of the chunks, each divided by the number of vectors
+  // that share it, with the given bytes per element.
+  template<typename elementt>
+  std::size_t memory(elementt element_memory) const
+  {
+    if(chunks==nullptr)
+      return 0;
+
+    std::size_t result=
+      chunks->size()*sizeof(std::shared_ptr<chunkt>)/chunks.use_count();
+
+    for(const auto &c : *chunks)
+    {
+      std::size_t bytes=sizeof(chunkt)+(chunk_size-c->size())*sizeof(T);
+
+      for(const auto &element : *c)
+        bytes+=element_memory(element);
+
+      result+=bytes/(c.use_count()*chunks.use_count());
+    }
+
+    return result;
+  }
+
+  std::size_t memory() const
+  {
+    return memory([](const T &) { return sizeof(T); });
+  }
+
+protected:
+  typedef std::vector<T> chunkt;
+  typedef std::vector<std::shared_ptr<chunkt>> chunkst;
+
+  std::shared_ptr<chunkst> chunks;
+  size_type number_of_elements;
+
+  chunkst &writable_chunks()
+  {
+    if(chunks==nullptr)
+      chunks=std::make_shared<chunkst>();
+    else if(chunks.use_count()>1)
+      chunks=std::make_shared<chunkst>(*chunks);
+
+    return *chunks;
+  }
+
+  chunkt &writable_chunk(size_type i)
+  {
+    std::shared_ptr<chunkt> &c=writable_chunks()[i];
+
+    if(c.use_count()>1)
+    {
+      std::shared_ptr<chunkt> copy=std::make_shared<chunkt>();
+      copy->reserve(chunk_size);
+      copy->insert(copy->end(), c->begin(), c->end());
+      c=copy;
+    }
+
+    return *c;
+  }
+};
+
+/// A map that is shared by its copies, and is copied when one of them
+/// writes to it. This suits maps that are small, or are rarely written.
+template<typename K, typename V>
+class cow_mapt
+{
+public:
+  typedef std::map<K, V> mapt;
+  typedef typename mapt::key_type key_type;
+  typedef typename mapt::mapped_type mapped_type;
+  typedef typename mapt::value_type value_type;
+  typedef typename mapt::const_iterator const_iterator;
+
+  std::size_t size() const
+  {
+    return map==nullptr?0:map->size();
+  }
+
+  bool empty() const
+  {
+    return size()==0;
+  }
+
+  const_iterator begin() const
+  {
+    return get().begin();
+  }
+
+  const_iterator end() const
+  {
+    return get().end();
+  }
+
+  const_iterator find(const K &key) const
+  {
+    return get().find(key);
+  }
+
+  // warning: the reference is not stable
+  V &operator[](const K &key)
+  {
+    return writable()[key];
+  }
+
+  bool operator==(const cow_mapt &other) const
+  {
+    return map==other.map || get()==other.get();
+  }
+
+  // the bytes of the map, divided by the number of maps that share it
+  std::size_t memory(std::size_t node_overhead) const
+  {
+    if(map==nullptr)
+      return 0;
+
+    return map->size()*(sizeof(value_type)+node_overhead)/map.use_count();
+  }
+
+protected:
+  std::shared_ptr<mapt> map;
+
+  const mapt &get() const
+  {
+    static const mapt empty_map;
+    return map==nullptr?empty_map:*map;
+  }
+
+  mapt &writable()
+  {
+    if(map==nullptr)
+      map=std::make_shared<mapt>();
+    else if(map.use_count()>1)
+      map=std::make_shared<mapt>(*map);
+
+    return *map;
+  }
+};
+
+#endif // CPROVER_PATH_SYMEX_COPY_ON_WRITE_H
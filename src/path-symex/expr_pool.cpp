@@ -0,0 +1,49 @@
+/*******************************************************************\
+
+Module: Pool of Shared Expressions
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Pool of Shared Expressions
+
+#include "expr_pool.h"
+
+const std::size_t expr_poolt::max_size;
+
+void expr_poolt::operator()(exprt &expr)
+{
+  if(store.size()>=max_size)
+  {
+    store.clear();
+    number_of_resets++;
+  }
+
+  static_cast<irept &>(expr)=pooled(expr);
+}
+
+/// The nodes that are in the pool already are found by their cached
+/// hashes, and by comparing the pointers to their data. The others
+/// are rebuilt from the pooled nodes of their subtrees.
+const irept &expr_poolt::pooled(const irept &irep)
+{
+  const auto entry=store.find(irep);
+
+  if(entry!=store.end())
+    return *entry;
+
+  irept new_irep(irep.id());
+
+  irept::subt &dest_sub=new_irep.get_sub();
+  dest_sub.reserve(irep.get_sub().size());
+
+  for(const auto &sub : irep.get_sub())
+    dest_sub.push_back(pooled(sub));
+
+  for(const auto &named_sub : irep.get_named_sub())
+    new_irep.add(named_sub.first, pooled(named_sub.second));
+
+  return *store.insert(std::move(new_irep)).first;
+}
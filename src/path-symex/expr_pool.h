@@ -0,0 +1,67 @@
+/*******************************************************************\
+
+Module: Pool of Shared Expressions
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Pool of Shared Expressions
+
+#ifndef CPROVER_PATH_SYMEX_EXPR_POOL_H
+#define CPROVER_PATH_SYMEX_EXPR_POOL_H
+
+#include <unordered_set>
+
+#include <util/expr.h>
+#include <util/irep.h>
+
+/// Hash-consing of expressions: equal expressions are replaced by a
+/// single shared node, and so are their subexpressions and types.
+/// Equal expressions from the pool are thus compared in constant
+/// time, as their nodes are the same, and their hashes are computed
+/// once, as these are cached in the nodes.
+///
+/// The pool keeps the expressions alive, and hence starts afresh
+/// once it holds 'max_size' nodes. The expressions that are shared
+/// by then remain so.
+class expr_poolt
+{
+public:
+  expr_poolt():number_of_resets(0)
+  {
+  }
+
+  // replaces the expression by the one in the pool
+  void operator()(exprt &);
+
+  std::size_t size() const
+  {
+    return store.size();
+  }
+
+  std::size_t get_number_of_resets() const
+  {
+    return number_of_resets;
+  }
+
+  void clear()
+  {
+    store.clear();
+  }
+
+  static const std::size_t max_size=1000000;
+
+protected:
+  // The hash ignores the comments, as the one of irept does, which
+  // is cached. The comments are compared, though.
+  typedef std::unordered_set<irept, irep_hash, irep_full_eq> storet;
+  storet store;
+
+  std::size_t number_of_resets;
+
+  const irept &pooled(const irept &);
+};
+
+#endif // CPROVER_PATH_SYMEX_EXPR_POOL_H
@@ -11,10 +11,197 @@ Author: Daniel Kroening, kroening@kroening.com
 
 #include "path_replay.h"
 
-void get_branches(path_symex_step_reft history)
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "path_symex.h"
+
+void path_replayt::get_branches(path_symex_step_reft history)
 {
+  branches.clear();
+
   // history trees are traversed effectively only backwards
   for(; !history.is_nil(); --history)
   {
+    // the branches of a merged state are not determined
+    if(history->is_merge())
+      throw path_symex_errort()
+        << "path replay: merged paths cannot be replayed";
+
+    if(history->is_branch())
+      branches.push_back(history->is_branch_taken());
+  }
+
+  std::reverse(branches.begin(), branches.end());
+}
+
+void path_replayt::replay(path_symex_statet &state) const
+{
+  std::size_t next_branch=0;
+
+  while(state.get_depth()<depth)
+  {
+    if(!state.is_executable())
+      throw path_symex_errort() << "path replay: path is dead";
+
+    if(state.get_instruction()->is_goto())
+    {
+      if(next_branch>=branches.size())
+        throw path_symex_errort() << "path replay: out of branches";
+
+      // this mirrors path_symext::operator()
+      state.increase_depth();
+      state.increase_no_branches();
+      path_symex_goto(state, branches[next_branch]);
+      next_branch++;
+    }
+    else
+      path_symex_replay(state, branches, next_branch);
+  }
+
+  if(next_branch!=branches.size())
+    throw path_symex_errort() << "path replay: unused branches";
+
+  if(state.get_current_thread()!=thread_nr ||
+     state.pc().function_identifier!=function ||
+     state.get_instruction()->location_number!=location_number)
+    throw path_symex_errort() << "path replay: wrong PC";
+}
+
+void path_replayt::output(std::ostream &out) const
+{
+  out << depth << ' ' << thread_nr << ' '
+      << function << ' ' << location_number << ' '
+      << branches.size() << ' ';
+
+  for(const auto b : branches)
+    out << (b?'1':'0');
+}
+
+bool path_replayt::input(std::istream &in)
+{
+  std::size_t size;
+  std::string function_string;
+
+  if(!(in >> depth >> thread_nr >> function_string
+          >> location_number >> size))
+    return true;
+
+  function=function_string;
+
+  branches.clear();
+  branches.reserve(size);
+
+  // skip the blank
+  in >> std::ws;
+
+  for(std::size_t i=0; i<size; i++)
+  {
+    const int c=in.get();
+    if(c=='1')
+      branches.push_back(true);
+    else if(c=='0')
+      branches.push_back(false);
+    else
+      return true;
+  }
+
+  return false;
+}
+
+static void write_number(std::ostream &out, std::size_t value)
+{
+  // 7 bits at a time, the high bit says whether more follow
+  while(value>=0x80)
+  {
+    out.put(static_cast<char>((value&0x7f)|0x80));
+    value>>=7;
+  }
+
+  out.put(static_cast<char>(value));
+}
+
+static bool read_number(std::istream &in, std::size_t &value)
+{
+  value=0;
+
+  for(unsigned shift=0; shift<64; shift+=7)
+  {
+    const int c=in.get();
+    if(c==EOF)
+      return true;
+
+    value|=static_cast<std::size_t>(c&0x7f)<<shift;
+
+    if((c&0x80)==0)
+      return false;
+  }
+
+  return true;
+}
+
+void path_replayt::write(std::ostream &out) const
+{
+  const std::string &function_string=id2string(function);
+
+  write_number(out, depth);
+  write_number(out, thread_nr);
+  write_number(out, function_string.size());
+  out.write(function_string.data(), function_string.size());
+  write_number(out, location_number);
+  write_number(out, branches.size());
+
+  for(std::size_t i=0; i<branches.size(); i+=8)
+  {
+    unsigned char byte=0;
+
+    for(std::size_t bit=0; bit<8 && i+bit<branches.size(); bit++)
+      if(branches[i+bit])
+        byte|=1<<bit;
+
+    out.put(static_cast<char>(byte));
   }
 }
+
+bool path_replayt::read(std::istream &in)
+{
+  std::size_t value, size;
+
+  if(read_number(in, depth))
+    return true;
+
+  if(read_number(in, value))
+    return true;
+  thread_nr=value;
+
+  if(read_number(in, size))
+    return true;
+  std::string function_string(size, ' ');
+  if(!in.read(&function_string[0], size))
+    return true;
+  function=function_string;
+
+  if(read_number(in, value))
+    return true;
+  location_number=value;
+
+  if(read_number(in, size))
+    return true;
+
+  branches.clear();
+  branches.reserve(size);
+
+  for(std::size_t i=0; i<size; i+=8)
+  {
+    const int byte=in.get();
+    if(byte==EOF)
+      return true;
+
+    for(std::size_t bit=0; bit<8 && i+bit<size; bit++)
+      branches.push_back((byte&(1<<bit))!=0);
+  }
+
+  return false;
+}
@@ -12,30 +12,77 @@ Author: Daniel Kroening, kroening@kroening.com
 #ifndef CPROVER_PATH_SYMEX_PATH_REPLAY_H
 #define CPROVER_PATH_SYMEX_PATH_REPLAY_H
 
+#include <iosfwd>
+
 #include "path_symex_state.h"
 
+/// A path, stored as the sequence of branch decisions taken along
+/// it, which include the choices of the callees of calls through
+/// function pointers, plus the number of steps. Replaying these
+/// decisions on the initial state yields a state that is equivalent
+/// to the original one.
+/// The thread and the PC at the end of the path are kept as well; they
+/// are checked after a replay.
 class path_replayt
 {
 public:
-  path_replayt()
+  path_replayt():depth(0), thread_nr(0), location_number(0)
   {
   }
 
-  explicit path_replayt(const path_symex_statet &src)
+  explicit path_replayt(const path_symex_statet &src):
+    depth(src.get_depth()),
+    thread_nr(src.get_current_thread()),
+    function(src.pc().function_identifier),
+    location_number(src.pc().target->location_number)
   {
     get_branches(src.history);
   }
 
-  void replay(path_symex_statet &);
+  // 'state' is expected to be the initial state
+  void replay(path_symex_statet &state) const;
+
+  std::size_t get_depth() const
+  {
+    return depth;
+  }
+
+  std::size_t number_of_branches() const
+  {
+    return branches.size();
+  }
+
+  unsigned get_thread_nr() const
+  {
+    return thread_nr;
+  }
+
+  const irep_idt &get_function() const
+  {
+    return function;
+  }
+
+  // text serialization, e.g., for passing paths between processes
+  void output(std::ostream &) const;
+  bool input(std::istream &);
+
+  // binary serialization, with eight branches per byte
+  void write(std::ostream &) const;
+  bool read(std::istream &);
 
 protected:
-  // TODO: consider something even denser, say something like a bitset
   typedef std::vector<bool> branchest;
   branchest branches;
 
-  void get_branches(const path_symex_step_reft history);
-};
+  // the number of steps on the path
+  std::size_t depth;
 
-void path_replay(path_symex_step_reft history);
+  // where the path ends
+  unsigned thread_nr;
+  irep_idt function;
+  unsigned location_number;
+
+  void get_branches(path_symex_step_reft history);
+};
 
 #endif // CPROVER_PATH_SYMEX_PATH_REPLAY_H
@@ -209,7 +209,7 @@ void path_symext::symex_va_start(
     const irep_idt id=id2string(function_id)+"::va_arg"+std::to_string(i);
     const var_mapt::var_infot &var_info=state.config.var_map[id];
     const path_symex_statet::var_statet &var_state =
-      state.get_var_state(var_info);
+      state.read_var_state(var_info);
     const exprt symbol_expr=symbol_exprt(id, var_state.ssa_symbol.value().type());
     auto address = address_of_exprt(symbol_expr);
     auto casted = typecast_exprt::conditional_cast(address, element_type);
@@ -220,8 +220,8 @@ void path_symext::symex_va_start(
   auto array_type = array_typet(element_type, from_integer(va_count, size_type()));
 
   const irep_idt base_name = "va_args"+std::to_string(state.config.var_map.nondet_count);
-  const irep_idt id="symex::"+id2string(base_name);
   state.config.var_map.nondet_count++;
+  const irep_idt id="symex::"+id2string(base_name);
 
   auxiliary_symbolt va_args_symbol;
   va_args_symbol.name=id;
@@ -322,14 +322,16 @@ void path_symext::assign_rec_symbol(
   stept &step=*state.history;
 
   step.ssa_guard=conjunction(guard);
-  step.lhs=var_info.original;
-  step.ssa_lhs=new_ssa_lhs;
+  step.assignment=std::unique_ptr<stept::assignmentt>(
+    new stept::assignmentt());
+  step.assignment->lhs=var_info.original;
+  step.assignment->ssa_lhs=new_ssa_lhs;
 
   if(ssa_rhs.is_nil())
     // this is a tautology, added so the solver knows about the symbol
-    step.ssa_rhs=new_ssa_lhs;
+    step.assignment->ssa_rhs=new_ssa_lhs;
   else
-    step.ssa_rhs=ssa_rhs;
+    step.assignment->ssa_rhs=ssa_rhs;
 }
 
 void path_symext::assign_rec_member(
@@ -583,17 +585,6 @@ void path_symext::assign_rec(
   }
 }
 
-static std::vector<symbol_exprt> get_local_variables(const goto_functiont &f)
-{
-  std::vector<symbol_exprt> result;
-
-  for(auto &i : f.body.instructions)
-    if(i.is_decl())
-      result.push_back(i.get_decl().symbol());
-
-  return result;
-}
-
 void path_symext::function_call_symbol(
   path_symex_statet &state,
   const code_function_callt &call,
@@ -626,23 +617,26 @@ void path_symext::function_call_symbol(
   }
 
   // record the function we call and the arguments
-  state.history->called_function=function_identifier;
-  state.history->function_arguments.resize(ssa_arguments.size());
+  state.history->function_call=std::unique_ptr<stept::function_callt>(
+    new stept::function_callt());
+  stept::function_callt &step_call=*state.history->function_call;
+  step_call.called_function=function_identifier;
+  step_call.function_arguments.resize(ssa_arguments.size());
 
   for(std::size_t i=0; i<ssa_arguments.size(); i++)
   {
     // store rhs
-    state.history->function_arguments[i].ssa_rhs=ssa_arguments[i];
+    step_call.function_arguments[i].ssa_rhs=ssa_arguments[i];
 
     // assign an lhs for every argument
     if(ssa_arguments[i].id()==ID_symbol)
-      state.history->function_arguments[i].ssa_lhs=to_symbol_expr(ssa_arguments[i]);
+      step_call.function_arguments[i].ssa_lhs=to_symbol_expr(ssa_arguments[i]);
     else
     {
       irep_idt id="symex_arg::"+id2string(function_identifier)+"::"+std::to_string(i);
       symbol_exprt arg_symbol(id, ssa_arguments[i].type());
       auto &var_info=state.config.var_map(id, irep_idt(), arg_symbol);
-      state.history->function_arguments[i].ssa_lhs=var_info.ssa_symbol();
+      step_call.function_arguments[i].ssa_lhs=var_info.ssa_symbol();
       var_info.increment_ssa_counter();
     }
   }
@@ -673,25 +667,11 @@ void path_symext::function_call_symbol(
   frame.hidden_function=function_entry.is_hidden();
   frame.va_count = 0; // set below
 
-  // save the locals into the frame, in case of recursion
-  for(const auto &v : get_local_variables(function_entry))
-  {
-    const auto nr=state.config.var_map(v).number;
-    thread.save_local_var(nr);
-  }
-
+  // the frame has fresh storage for the locals and the parameters,
+  // which hides those of any earlier call, in case of recursion
   const code_typet &code_type=function_entry.type;
   const code_typet::parameterst &function_parameters=code_type.parameters();
 
-  // save the parameters into the frame, in case of recursion
-  for(std::size_t i = 0; i<function_parameters.size(); i++)
-  {
-    auto v = symbol_exprt(
-      f_it->second.parameter_identifiers[i], function_parameters[i].type());
-    const auto nr=state.config.var_map(v).number;
-    thread.save_local_var(nr);
-  }
-
   // keep track when va arguments begin.
   std::size_t va_args_start_index=0;
 
@@ -803,12 +783,40 @@ void path_symext::function_call_rec(
     const if_exprt &if_expr=to_if_expr(function);
     exprt ssa_guard=if_expr.cond();
 
+    // The choice of the callee is recorded like a branch,
+    // with the true-case as the branch taken.
+    if(replay_branches!=nullptr)
+    {
+      if(*next_replay_branch>=replay_branches->size())
+        throw errort() << "path replay: out of branches";
+
+      const bool taken=(*replay_branches)[(*next_replay_branch)++];
+
+      state.record_step();
+
+      if(taken)
+      {
+        state.history->branch=stept::BRANCH_TAKEN;
+        state.history->ssa_guard=ssa_guard;
+        function_call_rec(state, call, if_expr.true_case(), further_states);
+      }
+      else
+      {
+        state.history->branch=stept::BRANCH_NOT_TAKEN;
+        state.history->ssa_guard=not_exprt(ssa_guard);
+        function_call_rec(state, call, if_expr.false_case(), further_states);
+      }
+
+      return;
+    }
+
     // add a 'further state' for the false-case
 
     {
       further_states.push_back(state);
       path_symex_statet &false_state=further_states.back();
       false_state.record_step();
+      false_state.history->branch=stept::BRANCH_NOT_TAKEN;
       false_state.history->ssa_guard=not_exprt(ssa_guard);
       function_call_rec(
         further_states.back(), call, if_expr.false_case(), further_states);
@@ -817,6 +825,7 @@ void path_symext::function_call_rec(
     // do the true-case in 'state'
     {
       state.record_step();
+      state.history->branch=stept::BRANCH_TAKEN;
       state.history->ssa_guard=ssa_guard;
       function_call_rec(state, call, if_expr.true_case(), further_states);
     }
@@ -863,22 +872,21 @@ void path_symext::return_from_function(path_symex_statet &state)
     // set PC to return location
     thread.pc=thread.call_stack.back().return_location;
 
-    // restore the local variables
-    for(const auto &v : thread.call_stack.back().saved_local_vars)
-    {
-      thread.local_vars[v.first]=v.second;
-    }
+    // read the return value in the frame of the callee
+    const auto &frame=thread.call_stack.back();
+    const optionalt<exprt> return_lhs=frame.return_lhs;
+    const optionalt<exprt> return_rhs=frame.return_rhs;
+    optionalt<exprt> ssa_return_rhs;
 
-    // assign the return value
-    if(thread.call_stack.back().return_rhs.has_value() &&
-       thread.call_stack.back().return_lhs.has_value())
-    {
-      assign(state, thread.call_stack.back().return_lhs.value(),
-                    thread.call_stack.back().return_rhs.value());
-    }
+    if(return_rhs.has_value() && return_lhs.has_value())
+      ssa_return_rhs=state.read(return_rhs.value());
 
-    // kill the frame
+    // kill the frame, and with it the locals of the callee
     thread.call_stack.pop_back();
+
+    // assign the return value in the frame of the caller
+    if(ssa_return_rhs.has_value())
+      assign(state, return_lhs.value(), ssa_return_rhs.value());
   }
 }
 
@@ -1019,7 +1027,14 @@ void path_symext::operator()(
       path_symex_statet::threadt &old_thread=
         state.threads[state.get_current_thread()];
       new_thread.pc=target;
-      new_thread.local_vars=old_thread.local_vars;
+
+      // the new thread starts in the function of the old one,
+      // and shares its locals, which it copies on write
+      new_thread.local_vars=old_thread.call_stack.empty()?
+        old_thread.local_vars:
+        old_thread.call_stack.back().local_vars;
+      new_thread.thread_local_vars=old_thread.thread_local_vars;
+      new_thread.other_local_vars=old_thread.other_local_vars;
     }
     break;
 
@@ -1223,6 +1238,16 @@ void path_symex(path_symex_statet &state)
   path_symex(state);
 }
 
+void path_symex_replay(
+  path_symex_statet &state,
+  const std::vector<bool> &branches,
+  std::size_t &next_branch)
+{
+  path_symext path_symex;
+  path_symex.set_replay_branches(branches, next_branch);
+  path_symex(state);
+}
+
 void path_symex_goto(
   path_symex_statet &state,
   bool taken)
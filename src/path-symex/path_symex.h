@@ -30,6 +30,15 @@ void path_symex(
 // Will fail if there is more than one successor state.
 void path_symex(path_symex_statet &state);
 
+// Transforms a state by executing a single statement other than a
+// goto, without splitting it up: the callee of a call through a
+// function pointer is chosen by the branch branches[next_branch],
+// and 'next_branch' is advanced past the branches that are used.
+void path_symex_replay(
+  path_symex_statet &state,
+  const std::vector<bool> &branches,
+  std::size_t &next_branch);
+
 // Transforms a state by executing a goto statement;
 // the 'taken' argument indicates which way.
 void path_symex_goto(
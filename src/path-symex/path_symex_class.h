@@ -17,7 +17,7 @@ Author: Daniel Kroening, kroening@kroening.com
 class path_symext
 {
 public:
-  path_symext()
+  path_symext():replay_branches(nullptr), next_replay_branch(nullptr)
   {
   }
 
@@ -42,11 +42,25 @@ public:
     state.history->ssa_guard=ssa_guard;
   }
 
+  // Replays the choice of the callee at the calls through function
+  // pointers: instead of splitting up, the state follows the branch
+  // branches[next_branch], and 'next_branch' is advanced past it.
+  void set_replay_branches(
+    const std::vector<bool> &branches,
+    std::size_t &next_branch)
+  {
+    replay_branches=&branches;
+    next_replay_branch=&next_branch;
+  }
+
   typedef path_symex_stept stept;
 
   using errort = path_symex_errort;
 
 protected:
+  const std::vector<bool> *replay_branches;
+  std::size_t *next_replay_branch;
+
   void do_goto(
     path_symex_statet &state,
     std::list<path_symex_statet> &further_states);
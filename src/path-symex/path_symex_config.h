@@ -12,6 +12,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #ifndef CPROVER_PATH_SYMEX_PATH_SYMEX_CONFIG_H
 #define CPROVER_PATH_SYMEX_PATH_SYMEX_CONFIG_H
 
+#include "expr_pool.h"
 #include "var_map.h"
 #include "path_symex_history.h"
 #include "path_symex_error.h"
@@ -41,6 +42,9 @@ public:
   var_mapt var_map;
   path_symex_historyt path_symex_history;
 
+  // the expressions that the states read are shared
+  expr_poolt expr_pool;
+
   path_symex_statet initial_state();
 
   goto_functionst::function_mapt::const_iterator
@@ -16,6 +16,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <solvers/decision_procedure.h>
 
 #include <util/format_expr.h>
+#include <util/irep_hash.h>
 
 void path_symex_stept::output(std::ostream &out) const
 {
@@ -30,22 +31,76 @@ void path_symex_stept::output(std::ostream &out) const
   out << "\n";
 
   out << "SSA Guard: " << format(ssa_guard) << "\n";
-  out << "LHS: " << format(lhs) << "\n";
-  out << "SSA LHS: " << format(ssa_lhs) << "\n";
-  out << "SSA RHS: " << format(ssa_rhs) << "\n";
+  out << "LHS: " << format(lhs()) << "\n";
+  out << "SSA LHS: " << format(ssa_lhs()) << "\n";
+  out << "SSA RHS: " << format(ssa_rhs()) << "\n";
   out << "\n";
 }
 
+const path_symex_stept::assignmentt &path_symex_stept::get_assignment() const
+{
+  static const assignmentt no_assignment;
+  return assignment==nullptr?no_assignment:*assignment;
+}
+
+const path_symex_stept::function_callt &
+path_symex_stept::get_function_call() const
+{
+  static const function_callt no_function_call;
+  return function_call==nullptr?no_function_call:*function_call;
+}
+
 void path_symex_stept::convert(decision_proceduret &dest) const
 {
-  for(const auto &arg : function_arguments)
-    dest << equal_exprt(arg.ssa_lhs, arg.ssa_rhs);
+  std::vector<exprt> constraints;
+  get_constraints(constraints);
 
-  if(ssa_rhs.is_not_nil())
-    dest << equal_exprt(ssa_lhs, ssa_rhs);
+  for(const auto &c : constraints)
+    dest << c;
+}
+
+void path_symex_stept::get_constraints(std::vector<exprt> &dest) const
+{
+  get_assignments(dest);
 
   if(ssa_guard.is_not_nil())
-    dest << ssa_guard;
+    dest.push_back(ssa_guard);
+}
+
+void path_symex_stept::get_assignments(std::vector<exprt> &dest) const
+{
+  for(const auto &arg : function_arguments())
+    dest.push_back(equal_exprt(arg.ssa_lhs, arg.ssa_rhs));
+
+  if(ssa_rhs().is_not_nil())
+    dest.push_back(equal_exprt(ssa_lhs(), ssa_rhs()));
+
+  if(is_merge())
+  {
+    // The assignments on both paths define distinct SSA symbols,
+    // and are thus kept. Their guards are in the merge guards.
+    for(const auto &path : merge->merged_paths)
+      for(path_symex_step_reft s=path; s!=predecessor; --s)
+        s->get_assignments(dest);
+
+    for(const auto &phi : merge->phis)
+      dest.push_back(equal_exprt(phi.ssa_lhs, phi.ssa_rhs));
+  }
+}
+
+path_symex_step_reft common_ancestor(
+  path_symex_step_reft a,
+  path_symex_step_reft b)
+{
+  while(a!=b)
+  {
+    if(a.is_after(b))
+      --a;
+    else
+      --b;
+  }
+
+  return a;
 }
 
 void path_symex_step_reft::build_history(
@@ -63,3 +118,92 @@ void path_symex_step_reft::build_history(
   // the above goes backwards: now need to reverse
   std::reverse(dest.begin(), dest.end());
 }
+
+std::size_t path_symex_step_reft::guard_fingerprint() const
+{
+  // the steps after the last one with a known fingerprint
+  std::vector<path_symex_step_reft> steps;
+
+  path_symex_step_reft s=*this;
+  for(; !s.is_nil() && !s->guard_fingerprint.has_value(); --s)
+    steps.push_back(s);
+
+  std::size_t result=s.is_nil()?0:s->guard_fingerprint.value();
+
+  for(auto it=steps.rbegin(); it!=steps.rend(); it++)
+  {
+    path_symex_stept &step=**it;
+
+    // a sum of the hashes of the guards is independent of their order
+    if(step.ssa_guard.is_not_nil() && !step.ssa_guard.is_true())
+      result+=hash_combine(0, step.ssa_guard.hash());
+
+    // the guards of merged paths are defined by the phis
+    if(step.is_merge())
+      for(const auto &phi : step.merge->phis)
+        result+=hash_combine(phi.ssa_lhs.hash(), phi.ssa_rhs.hash());
+
+    step.guard_fingerprint=result;
+  }
+
+  return result;
+}
+
+path_symex_stept &path_symex_historyt::new_step()
+{
+  path_symex_stept *step;
+
+  if(free_steps.empty())
+  {
+    step_container.emplace_back();
+    step=&step_container.back();
+  }
+  else
+  {
+    step=free_steps.back();
+    free_steps.pop_back();
+  }
+
+  step->bookkeeping.reference_count=1;
+  step->bookkeeping.number=number_of_steps++;
+
+  return *step;
+}
+
+/// Puts the step on the free list, together with the predecessors and
+/// merged paths that are referenced by it only. The references are
+/// dropped here rather than by their destructors, which would recurse
+/// along paths that may be very long.
+void path_symex_historyt::reclaim(path_symex_stept &step)
+{
+  std::vector<path_symex_stept *> unreferenced(1, &step);
+
+  while(!unreferenced.empty())
+  {
+    path_symex_stept &s=*unreferenced.back();
+    unreferenced.pop_back();
+
+    path_symex_step_reft *references[3]={ &s.predecessor, nullptr, nullptr };
+
+    if(s.is_merge())
+    {
+      references[1]=&s.merge->merged_paths[0];
+      references[2]=&s.merge->merged_paths[1];
+    }
+
+    for(auto r : references)
+    {
+      if(r==nullptr)
+        continue;
+
+      if(r->step!=nullptr && --r->step->bookkeeping.reference_count==0)
+        unreferenced.push_back(r->step);
+
+      r->step=nullptr;
+    }
+
+    // frees the expressions of the step
+    s=path_symex_stept();
+    free_steps.push_back(&s);
+  }
+}
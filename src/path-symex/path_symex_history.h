@@ -12,36 +12,77 @@ Author: Daniel Kroening, kroening@kroening.com
 #ifndef CPROVER_PATH_SYMEX_PATH_SYMEX_HISTORY_H
 #define CPROVER_PATH_SYMEX_PATH_SYMEX_HISTORY_H
 
-#include <limits>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include <util/base_exceptions.h>
+#include <util/optional.h>
 #include <util/std_expr.h>
 
 #include "loc_ref.h"
 
 class path_symex_stept;
 
-// This is a reference to a path_symex_stept,
-// and is really cheap to copy. These references are stable,
-// even though the underlying vector is not.
+// This is a reference to a path_symex_stept, and is cheap to copy.
+// The references are counted, and a step is reclaimed by the history
+// once there are none left, i.e., once no state, and no later step,
+// refers to it. These references are stable.
 class path_symex_step_reft
 {
 public:
   explicit path_symex_step_reft(
     class path_symex_historyt &_history):
-    index(std::numeric_limits<std::size_t>::max()),
+    step(nullptr),
     history(&_history)
   {
   }
 
-  path_symex_step_reft():
-    index(std::numeric_limits<std::size_t>::max()), history(nullptr)
+  path_symex_step_reft():step(nullptr), history(nullptr)
   {
   }
 
+  path_symex_step_reft(const path_symex_step_reft &other):
+    step(other.step), history(other.history)
+  {
+    acquire();
+  }
+
+  path_symex_step_reft(path_symex_step_reft &&other):
+    step(other.step), history(other.history)
+  {
+    other.step=nullptr;
+  }
+
+  path_symex_step_reft &operator=(const path_symex_step_reft &other)
+  {
+    path_symex_step_reft tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  path_symex_step_reft &operator=(path_symex_step_reft &&other)
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~path_symex_step_reft()
+  {
+    release();
+  }
+
+  void swap(path_symex_step_reft &other)
+  {
+    std::swap(step, other.step);
+    std::swap(history, other.history);
+  }
+
   bool is_nil() const
   {
-    return index==std::numeric_limits<std::size_t>::max();
+    return step==nullptr;
   }
 
   path_symex_historyt &get_history() const
@@ -59,28 +100,69 @@ public:
 
   void generate_successor();
 
+  bool operator==(const path_symex_step_reft &other) const
+  {
+    return step==other.step;
+  }
+
+  bool operator!=(const path_symex_step_reft &other) const
+  {
+    return step!=other.step;
+  }
+
+  // The steps are numbered in the order in which they are generated,
+  // and thus, a step comes after all of its predecessors.
+  bool is_after(const path_symex_step_reft &other) const;
+
+  // The number of the step, which identifies it also after its
+  // storage has been reclaimed and reused.
+  std::size_t get_number() const;
+
   // build a forward-traversable version of the history
   void build_history(std::vector<path_symex_step_reft> &dest) const;
 
+  // A hash of the path constraint up to and including this step,
+  // which does not depend on the order of the guards. It is cached
+  // in the steps, and thus computed in amortized constant time.
+  std::size_t guard_fingerprint() const;
+
+  // whether the step is referenced by other states or steps, too
+  bool is_shared() const;
+
 protected:
-  // we use a vector to store all steps
-  std::size_t index;
+  path_symex_stept *step;
   class path_symex_historyt *history;
 
   path_symex_stept &get() const;
+
+  void acquire();
+  void release();
+
+  friend class path_symex_historyt;
 };
 
 class decision_proceduret;
 
-// the actual history node
+// The actual history node. Most steps neither assign, call, nor merge,
+// and thus, the payloads of these are kept out of line, and are only
+// allocated for the steps that have them.
 class path_symex_stept
 {
 public:
-  enum kindt
+  enum kindt : std::uint8_t
   {
     NON_BRANCH, BRANCH_TAKEN, BRANCH_NOT_TAKEN
   } branch;
 
+  bool hidden;
+
+  // the path up to and including this step has been found to be
+  // feasible, which goes with the step when it is reclaimed
+  bool known_feasible;
+
+  // the thread that did the step
+  unsigned thread_nr;
+
   bool is_branch_taken() const
   {
     return branch==BRANCH_TAKEN;
@@ -98,24 +180,34 @@ public:
 
   path_symex_step_reft predecessor;
 
-  // the thread that did the step
-  unsigned thread_nr;
-
   // the instruction that was executed
   loc_reft pc;
 
-  // pre SSA, but dereferenced
-  exprt lhs;
-
   // in SSA
   exprt ssa_guard;
-  symbol_exprt ssa_lhs;
-  exprt ssa_rhs;
 
-  bool hidden;
+  // for assignments
+  struct assignmentt
+  {
+    exprt lhs; // pre SSA, but dereferenced
+    symbol_exprt ssa_lhs;
+    exprt ssa_rhs;
+
+    assignmentt():
+      lhs(nil_exprt()),
+      ssa_lhs(symbol_exprt(irep_idt(), typet())),
+      ssa_rhs(nil_exprt())
+    {
+    }
+  };
+  std::unique_ptr<assignmentt> assignment;
 
-  // for function call
-  irep_idt called_function;
+  // the lhs and the rhs are nil if the step does not assign
+  const exprt &lhs() const { return get_assignment().lhs; }
+  const symbol_exprt &ssa_lhs() const { return get_assignment().ssa_lhs; }
+  const exprt &ssa_rhs() const { return get_assignment().ssa_rhs; }
+
+  // for function calls
   struct function_argumentt
   {
     symbol_exprt ssa_lhs; exprt ssa_rhs;
@@ -123,23 +215,102 @@ public:
     {
     }
   };
-  std::vector<function_argumentt> function_arguments;
+
+  struct function_callt
+  {
+    irep_idt called_function;
+    std::vector<function_argumentt> function_arguments;
+  };
+  std::unique_ptr<function_callt> function_call;
+
+  const irep_idt &called_function() const
+  {
+    return get_function_call().called_function;
+  }
+
+  const std::vector<function_argumentt> &function_arguments() const
+  {
+    return get_function_call().function_arguments;
+  }
+
+  // For merged states: the ends of the two paths that were merged,
+  // which both start after the predecessor, and the guards that say
+  // which of them is taken. The variables that differ are assigned
+  // in 'phis'; the guard of the step is the disjunction of the two.
+  struct phit
+  {
+    symbol_exprt ssa_lhs; exprt ssa_rhs;
+    phit(const symbol_exprt &_ssa_lhs, const exprt &_ssa_rhs):
+      ssa_lhs(_ssa_lhs), ssa_rhs(_ssa_rhs)
+    {
+    }
+  };
+
+  struct merget
+  {
+    path_symex_step_reft merged_paths[2];
+    exprt merge_guards[2];
+    std::vector<phit> phis;
+  };
+  std::unique_ptr<merget> merge;
+
+  bool is_merge() const
+  {
+    return merge!=nullptr;
+  }
+
+  // see path_symex_step_reft::guard_fingerprint
+  optionalt<std::size_t> guard_fingerprint;
+
+  // The number of references to the step, and its number in the
+  // order of generation, which are kept by the history. A step that
+  // is moved does not take them along.
+  class bookkeepingt
+  {
+  public:
+    std::size_t reference_count;
+    std::size_t number;
+
+    bookkeepingt():reference_count(0), number(0)
+    {
+    }
+
+    bookkeepingt(const bookkeepingt &):bookkeepingt()
+    {
+    }
+
+    bookkeepingt &operator=(const bookkeepingt &)
+    {
+      return *this;
+    }
+  } bookkeeping;
 
   path_symex_stept():
     branch(NON_BRANCH),
+    hidden(false),
+    known_feasible(false),
     thread_nr(0),
-    lhs(nil_exprt()),
-    ssa_guard(nil_exprt()),
-    ssa_lhs(symbol_exprt(irep_idt(), typet())),
-    ssa_rhs(nil_exprt()),
-    hidden(false)
+    ssa_guard(nil_exprt())
   {
   }
 
+  path_symex_stept(path_symex_stept &&)=default;
+  path_symex_stept &operator=(path_symex_stept &&)=default;
+
   // interface to solvers; this converts a single step
   void convert(decision_proceduret &dest) const;
 
+  // the constraints that 'convert' passes to the solver
+  void get_constraints(std::vector<exprt> &dest) const;
+
+  // the assignments of the step, without its guard
+  void get_assignments(std::vector<exprt> &dest) const;
+
   void output(std::ostream &) const;
+
+protected:
+  const assignmentt &get_assignment() const;
+  const function_callt &get_function_call() const;
 };
 
 // converts the full history
@@ -156,28 +327,72 @@ inline decision_proceduret &operator<<(
   return dest;
 }
 
+// the latest step that both histories have in common
+path_symex_step_reft common_ancestor(
+  path_symex_step_reft a,
+  path_symex_step_reft b);
+
 // this stores the forest of histories
 class path_symex_historyt
 {
 public:
-  typedef std::vector<path_symex_stept> step_containert;
+  path_symex_historyt():number_of_steps(0)
+  {
+  }
+
+  // A deque does not move the steps when growing, hence
+  // references to the steps remain valid. The steps that are
+  // no longer referenced are put on the free list, and are reused.
+  typedef std::deque<path_symex_stept> step_containert;
   step_containert step_container;
 
-  // TODO: consider typedefing path_symex_historyt
+  // the steps that are in use
+  std::size_t size() const
+  {
+    return step_container.size()-free_steps.size();
+  }
+
+  // all references into the forest must be gone
   void clear()
   {
     step_container.clear();
+    free_steps.clear();
   }
+
+protected:
+  std::vector<path_symex_stept *> free_steps;
+  std::size_t number_of_steps;
+
+  path_symex_stept &new_step();
+  void reclaim(path_symex_stept &);
+
+  friend class path_symex_step_reft;
 };
 
+inline void path_symex_step_reft::acquire()
+{
+  if(step!=nullptr)
+    step->bookkeeping.reference_count++;
+}
+
+inline void path_symex_step_reft::release()
+{
+  if(step!=nullptr && --step->bookkeeping.reference_count==0)
+    history->reclaim(*step);
+
+  step=nullptr;
+}
+
 inline void path_symex_step_reft::generate_successor()
 {
   INVARIANT_STRUCTURED(
     history!=nullptr, nullptr_exceptiont, "history is null");
-  path_symex_step_reft old=*this;
-  index=history->step_container.size();
-  history->step_container.push_back(path_symex_stept());
-  history->step_container.back().predecessor=old;
+  path_symex_stept &successor=history->new_step();
+
+  // the reference to this step moves into the successor
+  successor.predecessor.step=step;
+  successor.predecessor.history=history;
+  step=&successor;
 }
 
 inline path_symex_step_reft &path_symex_step_reft::operator--()
@@ -188,10 +403,26 @@ inline path_symex_step_reft &path_symex_step_reft::operator--()
 
 inline path_symex_stept &path_symex_step_reft::get() const
 {
-  INVARIANT_STRUCTURED(
-    history!=nullptr, nullptr_exceptiont, "history is null");
   PRECONDITION(!is_nil());
-  return history->step_container[index];
+  return *step;
+}
+
+inline bool path_symex_step_reft::is_after(
+  const path_symex_step_reft &other) const
+{
+  return !is_nil() &&
+         (other.is_nil() ||
+          step->bookkeeping.number>other.step->bookkeeping.number);
+}
+
+inline std::size_t path_symex_step_reft::get_number() const
+{
+  return get().bookkeeping.number;
+}
+
+inline bool path_symex_step_reft::is_shared() const
+{
+  return step!=nullptr && step->bookkeeping.reference_count>1;
 }
 
 #endif // CPROVER_PATH_SYMEX_PATH_SYMEX_HISTORY_H
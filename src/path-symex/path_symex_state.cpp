@@ -11,9 +11,12 @@ Author: Daniel Kroening, kroening@kroening.com
 
 #include "path_symex_state.h"
 
+#include <algorithm>
+
 #include <util/arith_tools.h>
 #include <util/c_types.h>
 #include <util/format_expr.h>
+#include <util/irep_hash.h>
 
 #include <solvers/decision_procedure.h>
 
@@ -21,6 +24,20 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <iostream>
 #endif
 
+static void output_var_val(
+  const path_symex_statet::var_valt &var_val,
+  std::ostream &out)
+{
+  for(const auto &v : var_val)
+    if(v.ssa_symbol.has_value())
+    {
+      out << "  " << format(v.ssa_symbol.value());
+      if(v.value.has_value())
+        out << " = " << format(v.value.value());
+      out << '\n';
+    }
+}
+
 void path_symex_statet::output(const threadt &thread, std::ostream &out) const
 {
   out << "  PC: " << thread.pc << '\n';
@@ -32,12 +49,18 @@ void path_symex_statet::output(const threadt &thread, std::ostream &out) const
 
   out << '\n';
 
-  for(const auto &v : thread.local_vars)
-    if(v.ssa_symbol.has_value())
+  output_var_val(thread.thread_local_vars, out);
+  output_var_val(thread.local_vars, out);
+
+  for(const auto &frame : thread.call_stack)
+    output_var_val(frame.local_vars, out);
+
+  for(const auto &v : thread.other_local_vars)
+    if(v.second.ssa_symbol.has_value())
     {
-      out << "  " << format(v.ssa_symbol.value());
-      if(v.value.has_value())
-        out << " = " << format(v.value.value());
+      out << "  " << format(v.second.ssa_symbol.value());
+      if(v.second.value.has_value())
+        out << " = " << format(v.second.value.value());
       out << '\n';
     }
 }
@@ -66,10 +89,61 @@ path_symex_statet::var_statet &path_symex_statet::get_var_state(
 {
   assert(current_thread<threads.size());
 
-  var_valt &var_val=
-    var_info.is_shared()?shared_vars:threads[current_thread].local_vars;
+  if(var_info.is_shared())
+    return shared_vars[var_info.number];
+
+  threadt &thread=threads[current_thread];
+
+  if(var_info.kind==var_mapt::var_infot::THREAD_LOCAL)
+    return thread.thread_local_vars[var_info.number];
+
+  const auto frame=thread.find_frame(var_info.function);
+
+  if(!frame.has_value() || var_info.function.empty())
+    return thread.other_local_vars[var_info.full_identifier];
+
+  if(*frame==thread.call_stack.size())
+    return thread.local_vars[var_info.number];
+
+  return thread.call_stack[*frame].local_vars[var_info.number];
+}
+
+const path_symex_statet::var_statet &path_symex_statet::read_var_state(
+  const var_mapt::var_infot &var_info) const
+{
+  assert(current_thread<threads.size());
+
+  // the vectors expand on demand
+  static const var_statet unset;
+
+  const threadt &thread=threads[current_thread];
+  const var_valt *var_val;
+
+  if(var_info.is_shared())
+    var_val=&shared_vars;
+  else if(var_info.kind==var_mapt::var_infot::THREAD_LOCAL)
+    var_val=&thread.thread_local_vars;
+  else
+  {
+    const auto frame=thread.find_frame(var_info.function);
+
+    if(!frame.has_value() || var_info.function.empty())
+    {
+      const auto v_it=
+        thread.other_local_vars.find(var_info.full_identifier);
+      return v_it==thread.other_local_vars.end()?unset:v_it->second;
+    }
+
+    if(*frame==thread.call_stack.size())
+      var_val=&thread.local_vars;
+    else
+      var_val=&thread.call_stack[*frame].local_vars;
+  }
+
+  if(var_info.number>=var_val->size())
+    return unset;
 
-  return var_val[var_info.number];
+  return (*var_val)[var_info.number];
 }
 
 void path_symex_statet::record_step()
@@ -79,8 +153,13 @@ void path_symex_statet::record_step()
      history->thread_nr!=current_thread)
     no_thread_interleavings++;
 
+  // the steps so far are shared if another state refers to them
+  if(history.is_shared())
+    unshared_steps=0;
+
   // add the step
   history.generate_successor();
+  unshared_steps++;
   stept &step=*history;
 
   // copy PC
@@ -93,6 +172,212 @@ void path_symex_statet::record_step()
   step.hidden=get_hide();
 }
 
+std::size_t path_symex_statet::estimate_memory() const
+{
+  // the nodes of the std::maps carry about four pointers
+  const std::size_t node_overhead=4*sizeof(void *);
+
+  // the containers that are shared with other states
+  // count in part only
+  std::size_t result=sizeof(path_symex_statet);
+
+  result+=shared_vars.memory();
+
+  for(const auto &thread : threads)
+  {
+    result+=sizeof(threadt);
+    result+=thread.local_vars.memory();
+    result+=thread.thread_local_vars.memory();
+    result+=thread.other_local_vars.memory(node_overhead);
+    result+=thread.call_stack.memory(
+      [](const framet &frame)
+      {
+        return sizeof(framet)+frame.local_vars.memory();
+      });
+  }
+
+  result+=unwinding_map.memory(node_overhead);
+  result+=recursion_map.memory(node_overhead);
+
+  // most steps carry an assignment
+  result+=unshared_steps*
+    (sizeof(path_symex_stept)+sizeof(path_symex_stept::assignmentt));
+
+  return result;
+}
+
+/// a variable with a propagated value is equal to that value,
+/// whichever SSA symbol it has
+static std::size_t hash_var_state(const path_symex_statet::var_statet &v)
+{
+  if(v.value.has_value())
+    return v.value->hash();
+  else if(v.ssa_symbol.has_value())
+    return hash_combine(1, v.ssa_symbol->hash());
+  else
+    return 0;
+}
+
+static std::size_t hash_loc(const loc_reft &l)
+{
+  if(l.is_nil())
+    return 0;
+
+  return hash_combine(
+    irep_id_hash()(l.function_identifier), l.target->location_number);
+}
+
+static std::size_t hash_var_val(
+  std::size_t h,
+  const path_symex_statet::var_valt &var_val)
+{
+  for(std::size_t nr=0; nr<var_val.size(); nr++)
+  {
+    // unset variables are skipped, as the vectors expand on demand
+    const std::size_t v=hash_var_state(var_val[nr]);
+    if(v!=0)
+      h=hash_combine(hash_combine(h, nr), v);
+  }
+
+  return h;
+}
+
+std::size_t path_symex_statet::hash() const
+{
+  std::size_t h=hash_combine(current_thread, inside_atomic_section);
+
+  h=hash_var_val(h, shared_vars);
+
+  for(const auto &thread : threads)
+  {
+    h=hash_combine(h, hash_loc(thread.pc));
+    h=hash_combine(h, thread.active);
+    h=hash_var_val(h, thread.local_vars);
+    h=hash_var_val(hash_combine(h, 1), thread.thread_local_vars);
+
+    for(const auto &v : thread.other_local_vars)
+      h=hash_combine(
+        hash_combine(h, irep_id_hash()(v.first)), hash_var_state(v.second));
+
+    for(const auto &frame : thread.call_stack)
+    {
+      h=hash_combine(h, irep_id_hash()(frame.current_function));
+      h=hash_combine(h, hash_loc(frame.return_location));
+      h=hash_combine(h, frame.hidden_function);
+      h=hash_combine(h, frame.va_count);
+
+      if(frame.return_lhs.has_value())
+        h=hash_combine(h, frame.return_lhs->hash());
+
+      if(frame.return_rhs.has_value())
+        h=hash_combine(h, frame.return_rhs->hash());
+
+      h=hash_var_val(h, frame.local_vars);
+    }
+  }
+
+  for(const auto &u : unwinding_map)
+    h=hash_combine(hash_combine(h, hash_loc(u.first)), u.second);
+
+  for(const auto &r : recursion_map)
+    h=hash_combine(hash_combine(h, irep_id_hash()(r.first)), r.second);
+
+  return h;
+}
+
+/// the equality that hash_var_state hashes
+static bool same_var_state(
+  const path_symex_statet::var_statet &a,
+  const path_symex_statet::var_statet &b)
+{
+  if(a.value.has_value() || b.value.has_value())
+    return a.value==b.value;
+  else
+    return a.ssa_symbol==b.ssa_symbol;
+}
+
+static bool same_loc(const loc_reft &a, const loc_reft &b)
+{
+  return !(a<b) && !(b<a);
+}
+
+static bool same_var_val(
+  const path_symex_statet::var_valt &a,
+  const path_symex_statet::var_valt &b)
+{
+  const path_symex_statet::var_statet unset;
+  const std::size_t size=a.size()>b.size()?a.size():b.size();
+
+  for(std::size_t nr=0; nr<size; nr++)
+    if(!same_var_state(nr<a.size()?a[nr]:unset, nr<b.size()?b[nr]:unset))
+      return false;
+
+  return true;
+}
+
+bool path_symex_statet::is_equivalent(const path_symex_statet &other) const
+{
+  if(current_thread!=other.current_thread ||
+     inside_atomic_section!=other.inside_atomic_section ||
+     threads.size()!=other.threads.size() ||
+     !same_var_val(shared_vars, other.shared_vars))
+    return false;
+
+  for(std::size_t t=0; t<threads.size(); t++)
+  {
+    const threadt &a=threads[t], &b=other.threads[t];
+
+    if(!same_loc(a.pc, b.pc) ||
+       a.active!=b.active ||
+       !same_var_val(a.local_vars, b.local_vars) ||
+       !same_var_val(a.thread_local_vars, b.thread_local_vars) ||
+       a.other_local_vars.size()!=b.other_local_vars.size() ||
+       a.call_stack.size()!=b.call_stack.size())
+      return false;
+
+    if(!std::equal(
+         a.other_local_vars.begin(),
+         a.other_local_vars.end(),
+         b.other_local_vars.begin(),
+         [](
+           const var_state_mapt::value_type &x,
+           const var_state_mapt::value_type &y)
+         {
+           return x.first==y.first && same_var_state(x.second, y.second);
+         }))
+      return false;
+
+    for(std::size_t f=0; f<a.call_stack.size(); f++)
+    {
+      const framet &a_frame=a.call_stack[f], &b_frame=b.call_stack[f];
+
+      if(a_frame.current_function!=b_frame.current_function ||
+         !same_loc(a_frame.return_location, b_frame.return_location) ||
+         a_frame.hidden_function!=b_frame.hidden_function ||
+         a_frame.va_count!=b_frame.va_count ||
+         a_frame.return_lhs!=b_frame.return_lhs ||
+         a_frame.return_rhs!=b_frame.return_rhs ||
+         !same_var_val(a_frame.local_vars, b_frame.local_vars))
+        return false;
+    }
+  }
+
+  return
+    unwinding_map.size()==other.unwinding_map.size() &&
+    recursion_map.size()==other.recursion_map.size() &&
+    std::equal(
+      unwinding_map.begin(),
+      unwinding_map.end(),
+      other.unwinding_map.begin(),
+      [](
+        const unwinding_mapt::value_type &x,
+        const unwinding_mapt::value_type &y)
+      {
+        return same_loc(x.first, y.first) && x.second==y.second;
+      }) &&
+    recursion_map==other.recursion_map;
+}
+
 bool path_symex_statet::is_feasible(
   decision_proceduret &decision_procedure) const
 {
@@ -13,8 +13,8 @@ Author: Daniel Kroening, kroening@kroening.com
 #define CPROVER_PATH_SYMEX_PATH_SYMEX_STATE_H
 
 #include <util/cprover_prefix.h>
-#include <util/expanding_vector.h>
 
+#include "copy_on_write.h"
 #include "loc_ref.h"
 #include "path_symex_config.h"
 #include "path_symex_error.h"
@@ -29,7 +29,8 @@ public:
     current_thread(0),
     no_thread_interleavings(0),
     no_branches(0),
-    depth(0)
+    depth(0),
+    unshared_steps(0)
   {
   }
 
@@ -46,12 +47,14 @@ public:
     optionalt<symbol_exprt> ssa_symbol;
   };
 
-  // the values of the shared variables
-  using var_valt = expanding_vectort<var_statet>;
+  // The values of the shared variables. The containers of the state
+  // are copied on write, as the states are copied whenever the path
+  // forks.
+  using var_valt = cow_vectort<var_statet>;
   var_valt shared_vars;
 
-  // save+restore procedure-local variables
-  typedef std::map<unsigned, var_statet> var_state_mapt;
+  // the procedure-local variables whose function is not on the stack
+  typedef cow_mapt<irep_idt, var_statet> var_state_mapt;
 
   // procedure frame
   struct framet
@@ -61,7 +64,7 @@ public:
     loc_reft return_location;
     optionalt<exprt> return_lhs;
     optionalt<exprt> return_rhs;
-    var_state_mapt saved_local_vars;
+    var_valt local_vars; // the procedure-local variables of the function
     std::size_t va_count; // number of ... arguments
 
     framet():hidden_function(false)
@@ -70,7 +73,7 @@ public:
   };
 
   // call stack
-  typedef std::vector<framet> call_stackt;
+  typedef cow_vectort<framet, 8> call_stackt;
 
   // the state of a thread
   struct threadt
@@ -78,17 +81,33 @@ public:
   public:
     loc_reft pc;
     call_stackt call_stack; // the call stack
-    var_valt local_vars; // thread-local variables
+    var_valt local_vars; // the locals of the function the thread started in
+    var_valt thread_local_vars;
+    var_state_mapt other_local_vars;
     bool active;
 
     threadt():active(true)
     {
     }
 
-    void save_local_var(unsigned nr)
+    // The frame of the given function that is closest to the top of
+    // the stack, or call_stack.size() for the function the thread
+    // started in, which has no frame. Returns nothing if the function
+    // is not on the stack.
+    optionalt<std::size_t> find_frame(const irep_idt &function) const
     {
-      PRECONDITION(!call_stack.empty());
-      call_stack.back().saved_local_vars[nr] = local_vars[nr];
+      for(std::size_t i=call_stack.size(); i!=0; i--)
+        if(call_stack[i-1].current_function==function)
+          return i-1;
+
+      const irep_idt &bottom_function=call_stack.empty()?
+        pc.function_identifier:
+        call_stack[0].return_location.function_identifier;
+
+      if(bottom_function==function)
+        return call_stack.size();
+
+      return {};
     }
   };
 
@@ -123,6 +142,9 @@ public:
   // warning: reference is not stable
   var_statet &get_var_state(const var_mapt::var_infot &var_info);
 
+  // does not copy the variables, unlike get_var_state
+  const var_statet &read_var_state(const var_mapt::var_infot &var_info) const;
+
   bool inside_atomic_section;
 
   unsigned get_current_thread() const
@@ -267,16 +289,38 @@ public:
     return !history.is_nil() && history->is_branch();
   }
 
+  // Merges 'other', which is at the same PC with the same call stack,
+  // into this state. The variables with different values get fresh SSA
+  // symbols, defined by the guards of the two paths. Returns false,
+  // with the state unchanged, if the states are not compatible, or if
+  // more than 'max_differences' variables differ.
+  bool merge(const path_symex_statet &other, std::size_t max_differences);
+
+  // A hash of the PCs, the call stacks, the values of the variables
+  // and the loop and recursion counters. States with the same hash
+  // and the same path constraint behave the same from here on.
+  std::size_t hash() const;
+
+  // Whether the state agrees with 'other' in all that hash() hashes,
+  // which confirms a match of the hashes. The paths are not compared.
+  bool is_equivalent(const path_symex_statet &other) const;
+
+  // A rough estimate of the number of bytes owned by the state, not
+  // counting the expressions, which are shared. The history counts
+  // with the steps since the state last shared its history with
+  // another one, which only this state references.
+  std::size_t estimate_memory() const;
+
   bool is_feasible(class decision_proceduret &) const;
 
   bool check_assertion(class decision_proceduret &);
 
   // counts how many times we have executed backwards edges
-  typedef std::map<loc_reft, unsigned> unwinding_mapt;
+  typedef cow_mapt<loc_reft, unsigned> unwinding_mapt;
   unwinding_mapt unwinding_map;
 
   // similar for recursive function calls
-  typedef std::map<irep_idt, unsigned> recursion_mapt;
+  typedef cow_mapt<irep_idt, unsigned> recursion_mapt;
   recursion_mapt recursion_map;
 
 protected:
@@ -286,6 +330,10 @@ protected:
   unsigned no_branches;
   unsigned depth;
 
+  // the number of steps at the end of the history that are
+  // not shared with other states
+  std::size_t unshared_steps;
+
   exprt read(
     const exprt &src,
     bool propagate);
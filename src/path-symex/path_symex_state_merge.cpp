@@ -0,0 +1,277 @@
+/*******************************************************************\
+
+Module: State of path-based symbolic simulator
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// State of path-based symbolic simulator, merging of states
+
+#include "path_symex_state.h"
+
+#include <util/std_expr.h>
+
+static bool operator==(
+  const path_symex_statet::var_statet &a,
+  const path_symex_statet::var_statet &b)
+{
+  return a.value==b.value && a.ssa_symbol==b.ssa_symbol;
+}
+
+static bool operator!=(
+  const path_symex_statet::var_statet &a,
+  const path_symex_statet::var_statet &b)
+{
+  return !(a==b);
+}
+
+static bool same_frame(
+  const path_symex_statet::framet &a,
+  const path_symex_statet::framet &b)
+{
+  return a.current_function==b.current_function &&
+         a.hidden_function==b.hidden_function &&
+         a.return_location.function_identifier==
+           b.return_location.function_identifier &&
+         (a.return_location.is_nil() ||
+          a.return_location.target==b.return_location.target) &&
+         a.return_lhs==b.return_lhs &&
+         a.return_rhs==b.return_rhs &&
+         a.va_count==b.va_count;
+}
+
+/// Collects the variables whose values differ.
+/// \return false if the values cannot be merged
+static bool get_differences(
+  const path_symex_statet::var_valt &a,
+  const path_symex_statet::var_valt &b,
+  std::vector<std::size_t> &differences)
+{
+  const path_symex_statet::var_statet unset;
+  const std::size_t size=a.size()>b.size()?a.size():b.size();
+
+  for(std::size_t nr=0; nr<size; nr++)
+  {
+    const auto &a_var=nr<a.size()?a[nr]:unset;
+    const auto &b_var=nr<b.size()?b[nr]:unset;
+
+    if(a_var==b_var)
+      continue;
+
+    // the phi needs the SSA symbols of both sides
+    if(!a_var.ssa_symbol.has_value() ||
+       !b_var.ssa_symbol.has_value())
+      return false;
+
+    differences.push_back(nr);
+  }
+
+  return true;
+}
+
+template <class mapt>
+static void merge_max(mapt &dest, const mapt &src)
+{
+  for(const auto &entry : src)
+  {
+    auto &value=dest[entry.first];
+    if(value<entry.second)
+      value=entry.second;
+  }
+}
+
+bool path_symex_statet::merge(
+  const path_symex_statet &other,
+  std::size_t max_differences)
+{
+  // we only merge single-threaded states
+  if(!is_active() || !other.is_active() ||
+     threads.size()!=1 || other.threads.size()!=1 ||
+     inside_atomic_section || other.inside_atomic_section)
+    return false;
+
+  const threadt &thread=threads.front();
+  const threadt &other_thread=other.threads.front();
+
+  if(thread.pc.function_identifier!=other_thread.pc.function_identifier ||
+     thread.pc.target!=other_thread.pc.target ||
+     thread.active!=other_thread.active ||
+     thread.call_stack.size()!=other_thread.call_stack.size())
+    return false;
+
+  for(std::size_t i=0; i<thread.call_stack.size(); i++)
+    if(!same_frame(thread.call_stack[i], other_thread.call_stack[i]))
+      return false;
+
+  // the locals of functions that are not on the stack are rare,
+  // and are not merged
+  if(!(thread.other_local_vars==other_thread.other_local_vars))
+    return false;
+
+  // the variables of both states: the shared ones, the thread-local
+  // ones, the locals of the function the thread started in, and those
+  // of the frames
+  std::vector<std::pair<const var_valt *, const var_valt *>> var_vals;
+  var_vals.emplace_back(&shared_vars, &other.shared_vars);
+  var_vals.emplace_back(
+    &thread.thread_local_vars, &other_thread.thread_local_vars);
+  var_vals.emplace_back(&thread.local_vars, &other_thread.local_vars);
+
+  for(std::size_t i=0; i<thread.call_stack.size(); i++)
+    var_vals.emplace_back(
+      &thread.call_stack[i].local_vars,
+      &other_thread.call_stack[i].local_vars);
+
+  std::vector<std::vector<std::size_t>> differences(var_vals.size());
+  std::size_t number_of_differences=0;
+
+  for(std::size_t i=0; i<var_vals.size(); i++)
+  {
+    if(!get_differences(
+         *var_vals[i].first, *var_vals[i].second, differences[i]))
+      return false;
+
+    number_of_differences+=differences[i].size();
+  }
+
+  if(number_of_differences>max_differences)
+    return false;
+
+  // the paths must have split up
+  const path_symex_step_reft ancestor=
+    common_ancestor(history, other.history);
+
+  if(ancestor==history || ancestor==other.history)
+    return false;
+
+  // The guards of the two paths, as fresh symbols.
+  // Each is the conjunction of the guards after the split.
+  stept merge_step;
+  merge_step.merge=std::unique_ptr<stept::merget>(new stept::merget());
+  stept::merget &merge_data=*merge_step.merge;
+  const path_symex_step_reft ends[2]={ history, other.history };
+
+  for(std::size_t side=0; side<2; side++)
+  {
+    exprt::operandst guards;
+
+    for(path_symex_step_reft s=ends[side]; s!=ancestor; --s)
+      if(s->ssa_guard.is_not_nil())
+        guards.push_back(s->ssa_guard);
+
+    const symbol_exprt guard_symbol(
+      "symex::merge_guard#"+std::to_string(config.var_map.nondet_count),
+      bool_typet());
+    config.var_map.nondet_count++;
+
+    merge_data.merged_paths[side]=ends[side];
+    merge_data.merge_guards[side]=guard_symbol;
+    merge_data.phis.push_back(
+      stept::phit(guard_symbol, conjunction(guards)));
+  }
+
+  merge_step.ssa_guard=
+    or_exprt(merge_data.merge_guards[0], merge_data.merge_guards[1]);
+
+  // the phis of the variables that differ
+  auto merge_vars=[&](
+    var_valt &dest,
+    const var_valt &src,
+    const std::vector<std::size_t> &differences)
+  {
+    for(const auto nr : differences)
+    {
+      var_statet &dest_var=dest[nr];
+      const var_statet &src_var=src[nr];
+
+      const exprt dest_value=dest_var.value.has_value()?
+        dest_var.value.value():dest_var.ssa_symbol.value();
+      const exprt src_value=src_var.value.has_value()?
+        src_var.value.value():src_var.ssa_symbol.value();
+
+      var_mapt::var_infot &var_info=config.var_map[
+        dest_var.ssa_symbol.value().get(ID_C_full_identifier)];
+
+      var_info.increment_ssa_counter();
+      const symbol_exprt phi_symbol=var_info.ssa_symbol();
+
+      merge_data.phis.push_back(stept::phit(
+        phi_symbol,
+        if_exprt(merge_data.merge_guards[0], dest_value, src_value)));
+
+      dest_var.value={};
+      dest_var.ssa_symbol=phi_symbol;
+    }
+  };
+
+  // check the types first, as this state must remain unchanged
+  // if the merge fails
+  auto same_types=[](
+    const var_valt &a,
+    const var_valt &b,
+    const std::vector<std::size_t> &differences)
+  {
+    for(const auto nr : differences)
+    {
+      const typet &a_type=a[nr].value.has_value()?
+        a[nr].value->type():a[nr].ssa_symbol->type();
+      const typet &b_type=b[nr].value.has_value()?
+        b[nr].value->type():b[nr].ssa_symbol->type();
+
+      if(a_type!=b_type)
+        return false;
+    }
+
+    return true;
+  };
+
+  for(std::size_t i=0; i<var_vals.size(); i++)
+    if(!same_types(*var_vals[i].first, *var_vals[i].second, differences[i]))
+      return false;
+
+  // writing unshares the vectors, and thus only those that differ
+  // are written
+  for(std::size_t i=0; i<var_vals.size(); i++)
+  {
+    if(differences[i].empty())
+      continue;
+
+    threadt &dest_thread=threads.front();
+    var_valt &dest=
+      i==0?shared_vars:
+      i==1?dest_thread.thread_local_vars:
+      i==2?dest_thread.local_vars:
+      dest_thread.call_stack[i-3].local_vars;
+
+    merge_vars(dest, *var_vals[i].second, differences[i]);
+  }
+
+  // the bounds of the search hold for both paths
+  merge_max(unwinding_map, other.unwinding_map);
+  merge_max(recursion_map, other.recursion_map);
+
+  if(depth<other.depth)
+    depth=other.depth;
+
+  if(no_branches<other.no_branches)
+    no_branches=other.no_branches;
+
+  if(no_thread_interleavings<other.no_thread_interleavings)
+    no_thread_interleavings=other.no_thread_interleavings;
+
+  // the merge step follows the common ancestor
+  history=ancestor;
+  history.generate_successor();
+
+  stept &step=*history;
+  const path_symex_step_reft predecessor=step.predecessor;
+  step=std::move(merge_step);
+  step.predecessor=predecessor;
+  step.pc=thread.pc;
+  step.thread_nr=current_thread;
+  step.hidden=true;
+
+  return true;
+}
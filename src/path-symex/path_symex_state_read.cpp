@@ -45,6 +45,10 @@ exprt path_symex_statet::read(const exprt &src, bool propagate)
 
   exprt tmp4=simplify_expr(tmp3, config.ns);
 
+  // the same subexpressions are read over and over, and go into
+  // many steps of the history and values of variables
+  config.expr_pool(tmp4);
+
   #ifdef DEBUG
   std::cout << " ==> " << from_expr(tmp4) << '\n';
   #endif
@@ -500,20 +504,23 @@ optionalt<exprt> path_symex_statet::read_symbol_member_index(
             << " var_info " << var_info.full_identifier << '\n';
   #endif
 
-  // warning: reference is not stable
-  var_statet &var_state=get_var_state(var_info);
+  // reading does not copy the variables of a state that is shared
+  const var_statet &read_state=read_var_state(var_info);
 
-  if(propagate && var_state.value.has_value())
+  if(propagate && read_state.value.has_value())
   {
-    return var_state.value.value(); // propagate a value
+    return read_state.value.value(); // propagate a value
   }
-  else if(var_state.ssa_symbol.has_value())
+  else if(read_state.ssa_symbol.has_value())
   {
     // we have got an SSA symbol
-    return var_state.ssa_symbol.value();
+    return read_state.ssa_symbol.value();
   }
   else // never read before, no value
   {
+    // warning: reference is not stable
+    var_statet &var_state=get_var_state(var_info);
+
     // produce symbolic symbol
     var_state.ssa_symbol=var_info.ssa_symbol();
 
@@ -31,7 +31,7 @@ symbol_exprt var_mapt::var_infot::ssa_symbol() const
 var_mapt::var_mapt(const namespacet &_ns):
   ns(_ns.get_symbol_table(), new_symbols),
   shared_count(0),
-  local_count(0),
+  thread_local_count(0),
   nondet_count(0),
   dynamic_count(0)
 {
@@ -89,6 +89,9 @@ void var_mapt::var_infot::output(std::ostream &out) const
 
   out << "number: " << number << "\n";
 
+  if(!function.empty())
+    out << "function: " << function << "\n";
+
   out << "original: " << original.pretty() << "\n";
 
   out << "\n";
@@ -142,8 +145,44 @@ void var_mapt::init(var_infot &var_info)
 
   if(var_info.is_shared())
     var_info.number=shared_count++;
+  else if(var_info.kind==var_infot::THREAD_LOCAL)
+    var_info.number=thread_local_count++;
   else
-    var_info.number=local_count++;
+  {
+    var_info.function=get_function(var_info.symbol);
+    var_info.number=procedure_local_count[var_info.function]++;
+  }
+}
+
+/// The function of a procedure-local variable: the longest prefix of
+/// the identifier, up to a '::', that is a function. The arguments
+/// of calls are not part of a function.
+irep_idt var_mapt::get_function(const irep_idt &symbol) const
+{
+  const std::string &identifier=id2string(symbol);
+
+  if(has_prefix(identifier, "symex_arg::"))
+    return irep_idt();
+
+  const std::size_t va_arg=identifier.find("::va_arg");
+  if(va_arg!=std::string::npos)
+    return identifier.substr(0, va_arg);
+
+  std::size_t pos=identifier.rfind("::");
+
+  while(pos!=std::string::npos && pos!=0)
+  {
+    const irep_idt prefix=identifier.substr(0, pos);
+    const symbolt *function_symbol;
+
+    if(!ns.lookup(prefix, function_symbol) &&
+       function_symbol->type.id()==ID_code)
+      return prefix;
+
+    pos=identifier.rfind("::", pos-1);
+  }
+
+  return irep_idt();
 }
 
 irep_idt var_mapt::var_infot::ssa_identifier() const
@@ -36,12 +36,16 @@ public:
       return kind==SHARED;
     }
 
-    // the variables are numbered
+    // The variables are numbered: the shared ones, the thread-local
+    // ones, and the procedure-local ones of each function, each from 0.
     unsigned number;
 
     // full_identifier=symbol+suffix
     irep_idt full_identifier, symbol, suffix;
 
+    // the function of a procedure-local variable, if known
+    irep_idt function;
+
     // the symbol-member-index expression
     exprt original;
 
@@ -80,7 +84,8 @@ public:
   void clear()
   {
     shared_count=0;
-    local_count=0;
+    thread_local_count=0;
+    procedure_local_count.clear();
     nondet_count=0;
     dynamic_count=0;
     id_map.clear();
@@ -94,7 +99,10 @@ public:
   void output(std::ostream &) const;
 
 protected:
-  unsigned shared_count, local_count;
+  unsigned shared_count, thread_local_count;
+  std::map<irep_idt, unsigned> procedure_local_count;
+
+  irep_idt get_function(const irep_idt &symbol) const;
 
 public:
   unsigned nondet_count;  // free inputs
@@ -0,0 +1,157 @@
+/*******************************************************************\
+
+Module: Static Distances in the Interprocedural CFG
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Static Distances in the Interprocedural CFG
+
+#include "cfg_distance.h"
+
+#include <deque>
+
+const unsigned cfg_distancet::infinity;
+
+void cfg_distancet::build(const goto_functionst &goto_functions)
+{
+  function_map.clear();
+  locs.clear();
+  predecessors.clear();
+  distances.clear();
+
+  // number the locations
+  forall_goto_functions(f_it, goto_functions)
+  {
+    const goto_programt &body=f_it->second.body;
+
+    if(body.instructions.empty())
+      continue;
+
+    function_infot &info=function_map[f_it->first];
+    info.first_nr=locs.size();
+    info.first_location_number=body.instructions.begin()->location_number;
+
+    forall_goto_program_instructions(i_it, body)
+      locs.push_back(loc_reft(f_it->first, i_it));
+  }
+
+  predecessors.resize(locs.size());
+
+  // the return sites of the calls, by callee
+  std::unordered_map<irep_idt, std::vector<std::size_t>, irep_id_hash>
+    return_sites;
+
+  for(std::size_t nr=0; nr<locs.size(); nr++)
+  {
+    const goto_programt::instructiont &instruction=*locs[nr].target;
+
+    if(!instruction.is_function_call())
+      continue;
+
+    const exprt &function=instruction.get_function_call().function();
+
+    if(function.id()!=ID_symbol)
+      continue;
+
+    const irep_idt &identifier=to_symbol_expr(function).get_identifier();
+    const auto c_it=function_map.find(identifier);
+
+    if(c_it!=function_map.end())
+    {
+      add_edge(nr, c_it->second.first_nr);
+      return_sites[identifier].push_back(nr+1);
+    }
+  }
+
+  // the intraprocedural edges
+  for(std::size_t nr=0; nr<locs.size(); nr++)
+  {
+    const loc_reft &l=locs[nr];
+    const goto_programt::instructiont &instruction=*l.target;
+
+    // the successor in the same function, if any
+    const bool has_next=!instruction.is_end_function();
+
+    if(instruction.is_goto())
+    {
+      for(const auto &t : instruction.targets)
+        add_edge(nr, (*this)[loc_reft(l.function_identifier, t)]);
+
+      if(!instruction.get_condition().is_true() && has_next)
+        add_edge(nr, nr+1);
+    }
+    else if(instruction.is_start_thread())
+    {
+      for(const auto &t : instruction.targets)
+        add_edge(nr, (*this)[loc_reft(l.function_identifier, t)]);
+
+      add_edge(nr, nr+1);
+    }
+    else if(instruction.is_end_function())
+    {
+      const auto r_it=return_sites.find(l.function_identifier);
+
+      if(r_it!=return_sites.end())
+        for(const auto r : r_it->second)
+          add_edge(nr, r);
+    }
+    else if(instruction.is_function_call())
+    {
+      // calls of functions without body just continue
+      const exprt &function=instruction.get_function_call().function();
+
+      if(function.id()!=ID_symbol ||
+         function_map.find(to_symbol_expr(function).get_identifier())==
+           function_map.end())
+        add_edge(nr, nr+1);
+    }
+    else if(instruction.is_end_thread() || instruction.is_throw())
+    {
+    }
+    else if(has_next)
+      add_edge(nr, nr+1);
+  }
+}
+
+std::size_t cfg_distancet::operator[](const loc_reft &l) const
+{
+  const auto f_it=function_map.find(l.function_identifier);
+  PRECONDITION(f_it!=function_map.end());
+
+  // location numbers are consecutive within a function
+  return f_it->second.first_nr+
+         l.target->location_number-f_it->second.first_location_number;
+}
+
+void cfg_distancet::compute(const std::vector<bool> &targets)
+{
+  PRECONDITION(targets.size()==locs.size());
+
+  distances.assign(locs.size(), infinity);
+
+  // breadth-first, backwards from the targets
+  std::deque<std::size_t> queue;
+
+  for(std::size_t nr=0; nr<targets.size(); nr++)
+    if(targets[nr])
+    {
+      distances[nr]=0;
+      queue.push_back(nr);
+    }
+
+  while(!queue.empty())
+  {
+    const std::size_t nr=queue.front();
+    queue.pop_front();
+
+    for(const auto p : predecessors[nr])
+      if(distances[p]==infinity)
+      {
+        distances[p]=distances[nr]+1;
+        queue.push_back(p);
+      }
+  }
+}
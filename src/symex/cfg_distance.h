@@ -0,0 +1,82 @@
+/*******************************************************************\
+
+Module: Static Distances in the Interprocedural CFG
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Static Distances in the Interprocedural CFG
+
+#ifndef CPROVER_SYMEX_CFG_DISTANCE_H
+#define CPROVER_SYMEX_CFG_DISTANCE_H
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <goto-programs/goto_functions.h>
+
+#include <path-symex/loc_ref.h>
+
+/// Numbers all locations of the program densely, and computes the
+/// number of instructions on the shortest path from every location
+/// to the closest location of a given set. Calls go to the entry of
+/// the callee, and the end of a function goes to the return sites of
+/// all calls of the function.
+class cfg_distancet
+{
+public:
+  static const unsigned infinity=std::numeric_limits<unsigned>::max();
+
+  void build(const goto_functionst &);
+
+  std::size_t size() const
+  {
+    return locs.size();
+  }
+
+  // the dense number of a location
+  std::size_t operator[](const loc_reft &) const;
+
+  const loc_reft &get_loc(std::size_t nr) const
+  {
+    return locs[nr];
+  }
+
+  // computes the distances to the closest of the given locations
+  void compute(const std::vector<bool> &targets);
+
+  unsigned distance(std::size_t nr) const
+  {
+    return nr<distances.size()?distances[nr]:infinity;
+  }
+
+  unsigned distance(const loc_reft &l) const
+  {
+    return distance((*this)[l]);
+  }
+
+protected:
+  struct function_infot
+  {
+    std::size_t first_nr;
+    unsigned first_location_number;
+  };
+
+  typedef std::unordered_map<irep_idt, function_infot, irep_id_hash>
+    function_mapt;
+  function_mapt function_map;
+
+  std::vector<loc_reft> locs;
+  std::vector<std::vector<std::size_t>> predecessors;
+  std::vector<unsigned> distances;
+
+  void add_edge(std::size_t from, std::size_t to)
+  {
+    predecessors[to].push_back(from);
+  }
+};
+
+#endif // CPROVER_SYMEX_CFG_DISTANCE_H
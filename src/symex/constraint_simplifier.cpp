@@ -0,0 +1,228 @@
+/*******************************************************************\
+
+Module: Simplification of Path Constraints
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Simplification of Path Constraints
+
+#include "constraint_simplifier.h"
+
+#include <util/simplify_expr.h>
+
+constraint_simplifiert::constraint_simplifiert(
+  const std::vector<exprt> &_constraints,
+  const exprt &_goal,
+  const namespacet &_ns):
+  goal(_goal),
+  ns(_ns),
+  unchanged(true)
+{
+  for(const auto &c : _constraints)
+  {
+    exprt tmp=c;
+
+    bool changed=!substitute(tmp);
+    changed|=!apply_facts(tmp);
+
+    if(changed)
+    {
+      unchanged=false;
+      simplify(tmp, ns);
+    }
+
+    if(add(tmp))
+    {
+      set_false();
+      return;
+    }
+  }
+
+  // the symbols that are replaced later on
+  std::vector<exprt> kept;
+  kept.swap(constraints);
+
+  for(auto &c : kept)
+  {
+    if(!substitute(c))
+    {
+      simplify(c, ns);
+
+      if(c.is_true())
+        continue;
+
+      if(c.is_false())
+      {
+        set_false();
+        return;
+      }
+    }
+
+    constraints.push_back(std::move(c));
+  }
+
+  if(goal.is_not_nil())
+  {
+    bool changed=!substitute(goal);
+    changed|=!apply_facts(goal);
+
+    if(changed)
+    {
+      unchanged=false;
+      simplify(goal, ns);
+    }
+  }
+}
+
+/// Adds the conjuncts of the constraint, unless they are known, or
+/// define a symbol.
+/// \return true if the constraint is false
+bool constraint_simplifiert::add(const exprt &expr)
+{
+  if(expr.id()==ID_and)
+  {
+    unchanged=false;
+
+    for(const auto &op : expr.operands())
+      if(add(op))
+        return true;
+
+    return false;
+  }
+
+  if(expr.is_true())
+  {
+    unchanged=false;
+    return false;
+  }
+
+  if(expr.is_false())
+    return true;
+
+  // the conjuncts before may have added replacements
+  exprt tmp=expr;
+
+  if(!substitute(tmp))
+  {
+    unchanged=false;
+    simplify(tmp, ns);
+    return add(tmp);
+  }
+
+  if(expr.id()==ID_equal &&
+     (add_substitution(expr.op0(), expr.op1()) ||
+      add_substitution(expr.op1(), expr.op0())))
+  {
+    unchanged=false;
+    return false;
+  }
+
+  if(expr.id()==ID_not)
+    facts.emplace(expr.op0(), false);
+  else
+    facts.emplace(expr, true);
+
+  constraints.push_back(expr);
+  return false;
+}
+
+/// Replaces 'lhs' by 'rhs', if 'lhs' is an SSA symbol that is not
+/// replaced already, and 'rhs' is a symbol or a constant other than
+/// 'lhs'. The constraints so far are rewritten at the end.
+/// \return true if 'lhs' is replaced
+bool constraint_simplifiert::add_substitution(
+  const exprt &lhs,
+  const exprt &rhs)
+{
+  if(lhs.id()!=ID_symbol ||
+     !lhs.get_bool(ID_C_SSA_symbol) ||
+     (rhs.id()!=ID_symbol && rhs.id()!=ID_constant) ||
+     lhs.type()!=rhs.type())
+    return false;
+
+  const irep_idt &identifier=to_symbol_expr(lhs).get_identifier();
+
+  // the tautology of a nondeterministic assignment
+  if(rhs==lhs)
+    return true;
+
+  // the rhs has been substituted already, and so its symbol
+  // is not replaced by 'lhs'
+  return substitution.emplace(identifier, rhs).second;
+}
+
+/// replaces the symbols, including those that the replacements contain
+/// \return true if unchanged
+bool constraint_simplifiert::substitute(exprt &expr)
+{
+  if(expr.id()==ID_symbol)
+  {
+    const auto s_it=
+      substitution.find(to_symbol_expr(expr).get_identifier());
+
+    if(s_it==substitution.end())
+      return true;
+
+    // the replacement may have been replaced since
+    substitute(s_it->second);
+    expr=s_it->second;
+    return false;
+  }
+
+  // the objects of addresses are not values
+  if(expr.id()==ID_address_of || !expr.has_operands())
+    return true;
+
+  bool result=true;
+
+  Forall_operands(it, expr)
+    if(!substitute(*it))
+      result=false;
+
+  return result;
+}
+
+/// replaces the constraints that hold by true, and their negations by
+/// false
+/// \return true if unchanged
+bool constraint_simplifiert::apply_facts(exprt &expr) const
+{
+  if(facts.empty())
+    return true;
+
+  if(expr.type().id()==ID_bool)
+  {
+    const auto f_it=facts.find(expr);
+
+    if(f_it!=facts.end())
+    {
+      if(f_it->second)
+        expr=true_exprt();
+      else
+        expr=false_exprt();
+
+      return false;
+    }
+  }
+
+  if(expr.id()==ID_address_of || !expr.has_operands())
+    return true;
+
+  bool result=true;
+
+  Forall_operands(it, expr)
+    if(!apply_facts(*it))
+      result=false;
+
+  return result;
+}
+
+void constraint_simplifiert::set_false()
+{
+  unchanged=false;
+  constraints.clear();
+  constraints.push_back(false_exprt());
+}
@@ -0,0 +1,74 @@
+/*******************************************************************\
+
+Module: Simplification of Path Constraints
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Simplification of Path Constraints
+
+#ifndef CPROVER_SYMEX_CONSTRAINT_SIMPLIFIER_H
+#define CPROVER_SYMEX_CONSTRAINT_SIMPLIFIER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <util/namespace.h>
+#include <util/std_expr.h>
+
+/// Simplifies a conjunction of path constraints, in path order, and a
+/// goal, before they are handed to a decision procedure that is not
+/// incremental. The constraints are split at conjunctions, and
+///  - a constraint 'x=e', where 'x' is an SSA symbol and 'e' is a
+///    symbol or a constant, is dropped, and 'x' is replaced by 'e'
+///    everywhere, which takes care of copies, of constants, and of the
+///    tautologies 'x=x' of nondeterministic assignments;
+///  - a constraint that holds is replaced by true in the constraints
+///    that follow, and its negation by false, which propagates the
+///    guards, and drops the constraints that are there already.
+/// The result is equisatisfiable, but the symbols that are replaced
+/// have no value in the models.
+class constraint_simplifiert
+{
+public:
+  constraint_simplifiert(
+    const std::vector<exprt> &_constraints,
+    const exprt &_goal,
+    const namespacet &);
+
+  std::vector<exprt> constraints;
+  exprt goal;
+
+  // a constraint is false
+  bool is_false() const
+  {
+    return constraints.size()==1 && constraints.front().is_false();
+  }
+
+  // nothing has been simplified, and thus the models have the values
+  // of all symbols
+  bool is_unchanged() const
+  {
+    return unchanged;
+  }
+
+protected:
+  const namespacet &ns;
+  bool unchanged;
+
+  // the symbols that are replaced, and by what
+  std::unordered_map<irep_idt, exprt, irep_id_hash> substitution;
+
+  // the constraints that hold, and the negations of these
+  std::unordered_map<exprt, bool, irep_hash> facts;
+
+  bool substitute(exprt &);
+  bool apply_facts(exprt &) const;
+  bool add_substitution(const exprt &lhs, const exprt &rhs);
+  bool add(const exprt &);
+  void set_false();
+};
+
+#endif // CPROVER_SYMEX_CONSTRAINT_SIMPLIFIER_H
@@ -0,0 +1,119 @@
+/*******************************************************************\
+
+Module: Constraint Independence Slicing
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Constraint Independence Slicing
+
+#include "constraint_slicer.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <util/find_symbols.h>
+#include <util/union_find.h>
+
+namespace
+{
+struct itemt
+{
+  exprt expr;
+  path_symex_step_reft step;
+  bool is_guard;
+  find_symbols_sett symbols;
+};
+}
+
+constraint_slicert::constraint_slicert(
+  path_symex_step_reft history,
+  const exprt &goal):
+  number_of_path_constraints(0)
+{
+  std::vector<path_symex_step_reft> steps;
+  history.build_history(steps);
+
+  std::vector<itemt> items;
+  std::vector<exprt> assignments;
+
+  for(const auto &s : steps)
+  {
+    assignments.clear();
+    s->get_assignments(assignments);
+
+    for(const auto &a : assignments)
+      items.push_back(itemt{ a, s, false, find_symbols_sett() });
+
+    if(s->ssa_guard.is_not_nil())
+      items.push_back(itemt{ s->ssa_guard, s, true, find_symbols_sett() });
+  }
+
+  number_of_path_constraints=items.size();
+
+  // the constraints that share a symbol are in the same class
+  std::unordered_map<irep_idt, std::size_t, irep_id_hash> numbers;
+  unsigned_union_find classes;
+
+  auto number=[&numbers, &classes](const irep_idt &identifier)
+  {
+    const auto entry=numbers.emplace(identifier, numbers.size());
+    if(entry.second)
+      classes.resize(numbers.size());
+    return entry.first->second;
+  };
+
+  for(auto &item : items)
+  {
+    find_symbols(item.expr, item.symbols);
+
+    if(item.symbols.empty())
+      continue;
+
+    const std::size_t first=number(*item.symbols.begin());
+
+    for(const auto &identifier : item.symbols)
+      classes.make_union(first, number(identifier));
+  }
+
+  // the classes of the goal
+  find_symbols_sett goal_symbols;
+
+  if(goal.is_not_nil())
+    find_symbols(goal, goal_symbols);
+  else
+  {
+    for(auto it=items.rbegin(); it!=items.rend(); it++)
+      if(it->is_guard)
+      {
+        goal_symbols=it->symbols;
+        break;
+      }
+  }
+
+  std::unordered_set<std::size_t> cone;
+
+  for(const auto &identifier : goal_symbols)
+  {
+    const auto n_it=numbers.find(identifier);
+    if(n_it!=numbers.end())
+      cone.insert(classes.find(n_it->second));
+  }
+
+  // constants, such as a guard 'false', are always kept
+  for(const auto &item : items)
+  {
+    if(item.symbols.empty() ||
+       cone.find(classes.find(numbers[*item.symbols.begin()]))!=cone.end())
+    {
+      constraints.push_back(item.expr);
+
+      if(item.is_guard)
+        guards.push_back(item.expr);
+    }
+    else if(item.is_guard)
+      last_dropped_guard=item.step;
+  }
+}
@@ -0,0 +1,49 @@
+/*******************************************************************\
+
+Module: Constraint Independence Slicing
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Constraint Independence Slicing
+
+#ifndef CPROVER_SYMEX_CONSTRAINT_SLICER_H
+#define CPROVER_SYMEX_CONSTRAINT_SLICER_H
+
+#include <vector>
+
+#include <path-symex/path_symex_history.h>
+
+/// The constraints of a path that a goal depends on: those that share
+/// a symbol with the goal, or with a constraint that does, and so on.
+/// If the goal is nil, the guard of the last step with a guard is the
+/// goal. The other constraints only matter if they contradict each
+/// other, which cannot happen if the path up to the last guard that is
+/// dropped is known to be feasible; the assignments define fresh SSA
+/// symbols, and are always satisfiable.
+class constraint_slicert
+{
+public:
+  constraint_slicert(path_symex_step_reft history, const exprt &goal);
+
+  // the constraints in the dependency cone, in path order
+  std::vector<exprt> constraints;
+
+  // the guards among them
+  std::vector<exprt> guards;
+
+  // the last step whose guard is not in the cone, or nil
+  path_symex_step_reft last_dropped_guard;
+
+  // the number of constraints of the path
+  std::size_t number_of_path_constraints;
+
+  bool is_complete() const
+  {
+    return constraints.size()==number_of_path_constraints;
+  }
+};
+
+#endif // CPROVER_SYMEX_CONSTRAINT_SLICER_H
@@ -0,0 +1,156 @@
+/*******************************************************************\
+
+Module: Incremental Solving of Path Constraints
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Incremental Solving of Path Constraints
+
+#include "incremental_solver.h"
+
+const std::size_t incremental_solvert::min_steps_before_reset;
+const std::size_t incremental_solvert::path_factor;
+
+void incremental_solvert::reset()
+{
+  solver.reset();
+  solver=solver_factory(get_message_handler());
+
+  path_literals.clear();
+}
+
+void incremental_solvert::restart_if_needed(const path_symex_statet &state)
+{
+  // most of the steps belong to other paths
+  if(path_literals.size()>min_steps_before_reset &&
+     path_literals.size()>path_factor*state.get_depth())
+  {
+    debug() << "Restarting the solver" << eom;
+    restart();
+  }
+}
+
+decision_proceduret::resultt incremental_solvert::operator()(
+  const path_symex_statet &state,
+  const exprt &goal)
+{
+  restart_if_needed(state);
+
+  bvt assumptions;
+  assumptions.push_back(convert(state.history));
+
+  return solve(assumptions, goal);
+}
+
+decision_proceduret::resultt incremental_solvert::operator()(
+  const path_symex_statet &state,
+  const std::vector<exprt> &guards,
+  const exprt &goal)
+{
+  restart_if_needed(state);
+
+  // the assignments of the path are needed in any case
+  convert(state.history);
+
+  bvt assumptions;
+
+  for(const auto &guard : guards)
+    assumptions.push_back(solver->bv_pointers().convert(guard));
+
+  return solve(assumptions, goal);
+}
+
+decision_proceduret::resultt incremental_solvert::solve(
+  bvt assumptions,
+  const exprt &goal)
+{
+  bv_pointerst &bv_pointers=solver->bv_pointers();
+
+  if(goal.is_not_nil())
+    assumptions.push_back(bv_pointers.convert(goal));
+
+  bv_pointers.set_assumptions(assumptions);
+
+  return bv_pointers();
+}
+
+literalt incremental_solvert::convert_goal(
+  path_symex_step_reft history,
+  const exprt &goal)
+{
+  const literalt path=convert(history);
+  return solver->prop().land(path, solver->bv_pointers().convert(goal));
+}
+
+decision_proceduret::resultt incremental_solvert::solve_any(
+  const bvt &literals)
+{
+  bvt assumptions;
+  assumptions.push_back(solver->prop().lor(literals));
+
+  return solve(assumptions, nil_exprt());
+}
+
+/// adds the steps of the history that have not been added before
+/// \return the literal of the path up to the given step
+literalt incremental_solvert::convert(path_symex_step_reft history)
+{
+  std::vector<path_symex_step_reft> steps;
+  literalt result=const_literal(true);
+
+  for(; !history.is_nil(); --history)
+  {
+    const auto l_it=path_literals.find(history.get_number());
+
+    if(l_it!=path_literals.end())
+    {
+      result=l_it->second;
+      break;
+    }
+
+    steps.push_back(history);
+  }
+
+  for(auto s_it=steps.rbegin(); s_it!=steps.rend(); s_it++)
+  {
+    const path_symex_stept &step=**s_it;
+
+    convert_assignments(step);
+
+    if(step.ssa_guard.is_not_nil())
+      result=solver->prop().land(
+        result, solver->bv_pointers().convert(step.ssa_guard));
+
+    path_literals[s_it->get_number()]=result;
+  }
+
+  return result;
+}
+
+/// adds the assignments of the step, which hold on any path
+void incremental_solvert::convert_assignments(const path_symex_stept &step)
+{
+  bv_pointerst &bv_pointers=solver->bv_pointers();
+
+  for(const auto &arg : step.function_arguments())
+    bv_pointers.set_to_true(equal_exprt(arg.ssa_lhs, arg.ssa_rhs));
+
+  if(step.ssa_rhs().is_not_nil())
+    bv_pointers.set_to_true(equal_exprt(step.ssa_lhs(), step.ssa_rhs()));
+
+  if(step.is_merge())
+  {
+    // the steps of the merged paths, unless they have been
+    // added as part of a path already
+    for(const auto &path : step.merge->merged_paths)
+      for(path_symex_step_reft s=path; s!=step.predecessor; --s)
+        if(path_literals.find(s.get_number())==path_literals.end())
+          convert_assignments(*s);
+
+    for(const auto &phi : step.merge->phis)
+      bv_pointers.set_to_true(equal_exprt(phi.ssa_lhs, phi.ssa_rhs));
+  }
+}
@@ -0,0 +1,117 @@
+/*******************************************************************\
+
+Module: Incremental Solving of Path Constraints
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Incremental Solving of Path Constraints
+
+#ifndef CPROVER_SYMEX_INCREMENTAL_SOLVER_H
+#define CPROVER_SYMEX_INCREMENTAL_SOLVER_H
+
+#include <memory>
+#include <unordered_map>
+
+#include <util/message.h>
+
+#include <path-symex/path_symex_state.h>
+
+#include "solver_factory.h"
+
+/// A solver that is kept for the whole search, and to which the
+/// steps of the history are added once. The assignments of a step
+/// define fresh SSA symbols, and are thus added as they are, whatever
+/// path is checked later. The guards are not: every step gets a
+/// literal that is the conjunction of the guards on the path up to
+/// the step, and a path is checked under the assumption of the
+/// literal of its last step. Along a path, a query thus only adds the
+/// steps since the previous query.
+///
+/// The solver also keeps the steps of the paths that have been left
+/// behind. Once these make up most of it, it is started afresh. It
+/// is created by the given factory, which must be incremental.
+class incremental_solvert:public messaget
+{
+public:
+  incremental_solvert(
+    solver_factoryt &_solver_factory,
+    message_handlert &_message_handler):
+    messaget(_message_handler),
+    solver_factory(_solver_factory),
+    number_of_resets(0)
+  {
+    PRECONDITION(solver_factory.is_incremental());
+    reset();
+  }
+
+  // Checks the path constraint of the state, together with the
+  // given goal, unless it is nil.
+  decision_proceduret::resultt operator()(
+    const path_symex_statet &,
+    const exprt &goal);
+
+  // Checks the given guards of the path of the state, which are a
+  // subset of those on the path, together with the goal.
+  decision_proceduret::resultt operator()(
+    const path_symex_statet &,
+    const std::vector<exprt> &guards,
+    const exprt &goal);
+
+  // A literal that is true if the path up to the given step is taken,
+  // and the goal holds. These may be checked together, by solve_any.
+  literalt convert_goal(path_symex_step_reft history, const exprt &goal);
+
+  // checks whether any of the given literals can be true
+  decision_proceduret::resultt solve_any(const bvt &literals);
+
+  // the value of a literal in the model of the last satisfiable check
+  tvt get(literalt l) const
+  {
+    return solver->prop().l_get(l);
+  }
+
+  // the model of the last satisfiable check
+  const decision_proceduret &get_decision_procedure() const
+  {
+    return solver->decision_procedure();
+  }
+
+  // starts afresh, e.g., after the limits of the factory have changed
+  void restart()
+  {
+    reset();
+    number_of_resets++;
+  }
+
+  std::size_t get_number_of_resets() const
+  {
+    return number_of_resets;
+  }
+
+  // start afresh if the solver holds more than this many steps,
+  // and more than 'path_factor' times the steps of the path
+  static const std::size_t min_steps_before_reset=10000;
+  static const std::size_t path_factor=4;
+
+protected:
+  solver_factoryt &solver_factory;
+  std::unique_ptr<solver_factoryt::solvert> solver;
+
+  // the literals of the converted steps, by their numbers, as the
+  // storage of the steps is reused
+  typedef std::unordered_map<std::size_t, literalt> path_literalst;
+  path_literalst path_literals;
+
+  std::size_t number_of_resets;
+
+  void reset();
+  void restart_if_needed(const path_symex_statet &);
+  decision_proceduret::resultt solve(bvt assumptions, const exprt &goal);
+  literalt convert(path_symex_step_reft);
+  void convert_assignments(const path_symex_stept &);
+};
+
+#endif // CPROVER_SYMEX_INCREMENTAL_SOLVER_H
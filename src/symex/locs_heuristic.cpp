@@ -0,0 +1,50 @@
+/*******************************************************************\
+
+Module: Coverage-Guided Search Heuristic
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Coverage-Guided Search Heuristic
+
+#include "locs_heuristic.h"
+
+const std::size_t locs_heuristict::update_interval;
+
+void locs_heuristict::build(const goto_functionst &goto_functions)
+{
+  location_strategyt::build(goto_functions);
+  unvisited.assign(cfg_distance.size(), true);
+  cfg_distance.compute(unvisited);
+  dirty=false;
+  picks_since_update=0;
+}
+
+void locs_heuristict::visit(const loc_reft &l)
+{
+  const std::size_t nr=cfg_distance[l];
+
+  if(!unvisited[nr])
+    return;
+
+  unvisited[nr]=false;
+  dirty=true;
+}
+
+locs_heuristict::queuet::iterator locs_heuristict::pick()
+{
+  picks_since_update++;
+
+  // recompute the distances, and reorder the locations with states
+  if(dirty && picks_since_update>=update_interval)
+  {
+    cfg_distance.compute(unvisited);
+    update_scores();
+    dirty=false;
+    picks_since_update=0;
+  }
+
+  return location_strategyt::pick();
+}
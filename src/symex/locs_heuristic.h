@@ -0,0 +1,54 @@
+/*******************************************************************\
+
+Module: Coverage-Guided Search Heuristic
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Coverage-Guided Search Heuristic
+
+#ifndef CPROVER_SYMEX_LOCS_HEURISTIC_H
+#define CPROVER_SYMEX_LOCS_HEURISTIC_H
+
+#include "search_strategy.h"
+
+/// Prefers the states whose PC is closest to a location that has not
+/// been visited yet. The distances are recomputed lazily when new
+/// locations have been visited; ties are broken in favor of the most
+/// recent state.
+class locs_heuristict:public location_strategyt
+{
+public:
+  locs_heuristict():
+    dirty(false),
+    picks_since_update(0)
+  {
+  }
+
+  void build(const goto_functionst &) override;
+  void visit(const loc_reft &) override;
+
+  unsigned distance(const loc_reft &l) const
+  {
+    return cfg_distance.distance(l);
+  }
+
+  // recompute the distances at most every this many picks
+  static const std::size_t update_interval=100;
+
+protected:
+  std::vector<bool> unvisited;
+  bool dirty;
+  std::size_t picks_since_update;
+
+  unsigned score(std::size_t nr) const override
+  {
+    return cfg_distance.distance(nr);
+  }
+
+  queuet::iterator pick() override;
+};
+
+#endif // CPROVER_SYMEX_LOCS_HEURISTIC_H
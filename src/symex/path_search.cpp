@@ -11,12 +11,18 @@ Author: Daniel Kroening, kroening@kroening.com
 
 #include "path_search.h"
 
-#include <solvers/flattening/bv_pointers.h>
-#include <solvers/sat/satcheck.h>
+#include <util/irep_hash.h>
 
 #include <path-symex/path_symex.h>
 #include <path-symex/build_goto_trace.h>
 
+#include "target_strategy.h"
+
+const std::size_t path_searcht::reload_batch_size;
+const std::size_t path_searcht::max_pending_goals;
+const unsigned path_searcht::max_retry_rounds;
+const unsigned path_searcht::retry_factor;
+
 path_searcht::resultt path_searcht::operator()(
   const goto_functionst &goto_functions)
 {
@@ -28,7 +34,6 @@ path_searcht::resultt path_searcht::operator()(
   // this is the container for the history-forest
   path_symex_historyt history;
 
-  queue.push_back(config.initial_state());
 
   // count locs
   std::size_t loc_count = 0;
@@ -37,6 +42,16 @@ path_searcht::resultt path_searcht::operator()(
 
   // set up the statistics
   number_of_dropped_states=0;
+  number_of_duplicate_states=0;
+  number_of_spilled_states=0;
+  number_of_reloaded_states=0;
+  number_of_merged_states=0;
+  number_of_path_constraints=0;
+  number_of_sliced_constraints=0;
+  number_of_simplified_constraints=0;
+  number_of_unknown_queries=0;
+  number_of_retried_states=0;
+  retry_round=0;
   number_of_paths=0;
   number_of_VCCs=0;
   number_of_steps=0;
@@ -48,139 +63,490 @@ path_searcht::resultt path_searcht::operator()(
 
   // stop the time
   start_time=std::chrono::steady_clock::now();
-  auto last_reported_time=start_time;
+  last_reported_time=start_time;
 
   initialize_property_map(goto_functions);
+  seen_states.clear();
+  query_cache=query_cachet();
 
-  while(!queue.empty())
+  if(!query_cache_directory.empty())
   {
-    number_of_steps++;
+    query_cache.open_persistent(query_cache_directory);
+    status() << "Query cache: " << query_cache.persistent_size()
+             << " results in " << query_cache_directory << eom;
+  }
 
-    // Pick a state from the queue,
-    // according to some heuristic.
-    // The state moves to the head of the queue.
-    pick_state();
+  pending_goals.clear();
+
+  if(solver_factory.is_incremental())
+    solver=std::unique_ptr<incremental_solvert>(
+      new incremental_solvert(solver_factory, get_message_handler()));
+  else
+    solver=nullptr;
+
+  // merged states have no path that could be replayed
+  if(merge_states &&
+     (deepening_depth!=0 || fork_workers>0 ||
+      queue_memory_limit!=std::numeric_limits<std::size_t>::max()))
+  {
+    warning() << "merging of states is not supported with "
+              << "--iterative-deepening, --fork-workers "
+              << "or --queue-memory" << eom;
+    merge_states=false;
+  }
+
+  if(solver_threads!=0)
+  {
+    if(fork_workers>0)
+      warning() << "--solver-threads is not supported with "
+                << "--fork-workers" << eom;
+    else if(!solver_factory.can_solve_propositionally())
+      warning() << "--solver-threads is only supported with "
+                << "the default SAT backend" << eom;
+    else
+    {
+      if(solver_factory.get_time_limit()!=0)
+        warning() << "--solver-time-limit does not apply to "
+                  << "the solver threads" << eom;
+
+      solver_pool=std::unique_ptr<solver_poolt>(
+        new solver_poolt(solver_threads));
+    }
+  }
+
+  // set up the search strategy, and queue the initial state
+  set_up_strategy(goto_functions);
+
+  queuet initial_queue;
+  initial_queue.push_back(config.initial_state());
+  queue.push(initial_queue);
+
+  try
+  {
+    if(deepening_depth!=0)
+      iterative_deepening_search(config);
+    else if(fork_workers>0)
+      fork_search(config);
+    else
+      sequential_search(config);
+
+    // the goals of the paths that were not completed
+    check_pending_goals();
+  }
+  catch(...)
+  {
+    clear_states();
+    throw;
+  }
+
+  clear_states();
+
+  report_statistics(config);
+
+  return number_of_failed_properties==0?resultt::SAFE:resultt::UNSAFE;
+}
+
+/// Drops the states and queries that are left when the search stops,
+/// as they refer to the history, which goes with the configuration.
+void path_searcht::clear_states()
+{
+  // the queries that are left when the search stops early
+  async_queries.clear();
+  solver_pool.reset();
+
+  queue.clear();
+  pending_goals.clear();
+  spilled_states.clear();
+  frontier.clear();
+  unknown_states.clear();
+  seen_states.clear();
+}
+
+void path_searcht::set_up_strategy(const goto_functionst &goto_functions)
+{
+  if(target_lines.empty() && target_properties.empty())
+  {
+    // DFS continues a path past a join point before the
+    // other paths arrive there
+    const std::string name=
+      merge_states && search_strategy=="dfs"?"topological":search_strategy;
+
+    queue.set_strategy(new_search_strategy(name, seed));
+    queue.get_strategy().build(goto_functions);
+    return;
+  }
+
+  // directed search
+  std::unique_ptr<target_strategyt> strategy(new target_strategyt());
 
-    // move into temporary queue
+  for(const auto &l : target_lines)
+    strategy->add_target_line(l.first, l.second);
+
+  for(const auto &p : target_properties)
+    strategy->add_target_property(p);
+
+  strategy->build(goto_functions);
+
+  if(strategy->get_number_of_targets()==0)
+    warning() << "no instruction matches the search target" << eom;
+  else
+    status() << "Directing the search towards "
+             << strategy->get_number_of_targets()
+             << " instruction(s)" << eom;
+
+  queue.set_strategy(std::move(strategy));
+}
+
+/// explores the states in 'queue' until it is empty, and no state
+/// waits for a solver thread
+void path_searcht::sequential_search(path_symex_configt &config)
+{
+  while(!queue.empty() || !spilled_states.empty() ||
+        !async_queries.empty() || !unknown_states.empty())
+  {
+    // worker processes talk to their parent
+    if(result_fd!=-1)
+      fork_worker_poll();
+
+    // the results of the solver threads; if there is
+    // nothing else to do, wait for one
+    if(!async_queries.empty() &&
+       apply_solver_results(queue.empty() && spilled_states.empty()))
+    {
+      stop_search=true;
+      break;
+    }
+
+    // bring back states from disk
+    if(queue.empty())
+    {
+      if(!spilled_states.empty())
+        reload_states(config);
+      else if(!unknown_states.empty())
+        retry_unknown_states();
+      continue;
+    }
+
+    // Pick a state from the queue,
+    // according to the search strategy,
+    // and move it into a temporary queue.
     queuet tmp_queue;
-    tmp_queue.splice(
-      tmp_queue.begin(), queue, queue.begin(), ++queue.begin());
+    queue.pop(tmp_queue);
 
-    try
+    if(merge_states)
+      merge_queued_states(tmp_queue.front());
+
+    if(execute(tmp_queue))
     {
-      statet &state=tmp_queue.front();
+      stop_search=true;
+      break;
+    }
 
-      // record we have seen it
-      loc_data[state.pc()].visited=true;
+    // queue the successors
+    queue.push(tmp_queue);
 
-      debug() << "Loc: " << state.pc()
-              << ", queue: " << queue.size()
-              << ", depth: " << state.get_depth();
-      for(const auto &s : queue)
-        debug() << ' ' << s.get_depth();
+    if(queue.estimate_memory()>queue_memory_limit)
+      spill_states();
+  }
+}
 
-      debug() << eom;
+/// Queues the states whose feasibility was unknown again, with a
+/// larger time limit for the solver. Their feasibility is checked
+/// again, as they have just branched.
+void path_searcht::retry_unknown_states()
+{
+  retry_round++;
 
-      // dead already?
-      if(!state.is_executable())
-      {
-        goto_programt::const_targett pc=state.get_instruction();
-        debug() << "path is dead at "
-                << pc->source_location
-                << " thread " << state.get_current_thread()
-                << eom;
-        number_of_paths++;
-        continue;
-      }
+  const unsigned time_limit=
+    solver_factory.get_time_limit()*retry_factor;
+  solver_factory.set_time_limit(time_limit);
 
-      // drop deliberately?
-      if(drop_state(state))
-      {
-        number_of_dropped_states++;
-        number_of_paths++;
-        continue;
-      }
+  // the incremental solver has the old limit
+  if(solver!=nullptr)
+    solver->restart();
 
-      // check feasibility
-      if(eager_infeasibility &&
-         state.last_was_branch() &&
-         !is_feasible(state))
-      {
-        number_of_infeasible_paths++;
-        number_of_paths++;
-        continue;
-      }
+  status() << "Retrying " << unknown_states.size()
+           << " state(s) with a time limit of " << time_limit << "s"
+           << eom;
 
-      if(number_of_steps%10==0)
-      {
-        auto now=std::chrono::steady_clock::now();
-        if(now>=last_reported_time+std::chrono::seconds(1))
-        {
-          last_reported_time=now;
-          auto running_time=now-start_time;
-          status() << "Queue " << queue.size()
-                   << " thread " << state.get_current_thread()+1
-                   << '/' << state.threads.size()
-                   << " PC " << state.pc()
-                   << " depth " << state.get_depth()
-                   << " [" << number_of_steps << " steps, "
-                   << std::chrono::duration<double>(running_time).count()
-                   << "s]" << messaget::eom;
-        }
-      }
+  number_of_retried_states+=unknown_states.size();
+  queue.push(unknown_states);
+}
 
-      // an error, possibly?
-      if(state.get_instruction()->is_assert())
-      {
-        if(show_vcc)
-          do_show_vcc(state);
-        else
-        {
-          check_assertion(state);
+/// Merges the queued states that are at the same join point
+/// into the given one. Merging pays off if few variables differ:
+/// the paths are then explored once, and the solver gets if-then-else
+/// expressions over a few variables. Otherwise, the merged state
+/// would carry large formulas, and the states are kept apart.
+void path_searcht::merge_queued_states(statet &state)
+{
+  if(!state.is_executable() || !state.get_instruction()->is_target())
+    return;
 
-          // all assertions failed?
-          if(number_of_failed_properties==property_map.size())
-            break;
+  for(queuet::iterator it=queue.begin(); it!=queue.end();)
+  {
+    if(it->is_executable() &&
+       it->pc().function_identifier==state.pc().function_identifier &&
+       it->pc().target==state.pc().target &&
+       state.merge(*it, merge_limit))
+    {
+      number_of_merged_states++;
+      it=queue.erase(it);
+    }
+    else
+      ++it;
+  }
+}
 
-          // do we stop on failure?
-          if(number_of_failed_properties>=1 && stop_on_fail)
-            break;
-        }
-      }
+/// Explores up to the depth bound, then continues the states cut off
+/// at the bound with a bound that is larger by the deepening factor.
+/// The subtrees that were explored completely are not visited again.
+/// The states at the bound are stored as paths, and are rebuilt by
+/// replaying them, which does not repeat any solver calls.
+void path_searcht::iterative_deepening_search(path_symex_configt &config)
+{
+  deepening_max_depth=depth_limit;
+  unsigned bound=deepening_depth;
+  stop_search=false;
 
-      // execute
-      path_symex(state, tmp_queue);
+  while(true)
+  {
+    depth_limit=bound<deepening_max_depth?bound:deepening_max_depth;
+
+    status() << "Iterative deepening: depth " << depth_limit << eom;
+
+    sequential_search(config);
+
+    if(stop_search || frontier.empty())
+      break;
+
+    // the states at the bound are explored next
+    spilled_states.swap(frontier);
+
+    if(bound>=deepening_max_depth/deepening_factor)
+      bound=deepening_max_depth;
+    else
+      bound*=deepening_factor;
+  }
+
+  depth_limit=deepening_max_depth;
+}
 
-      // put at head of main queue
-      queue.splice(queue.begin(), tmp_queue);
+/// moves states from the queue to disk, until the queue
+/// uses three quarters of its memory limit
+void path_searcht::spill_states()
+{
+  while(queue.size()>=2 &&
+        queue.estimate_memory()>queue_memory_limit/4*3)
+  {
+    queuet tmp_queue;
+    queue.pop_cold(tmp_queue);
+    spilled_states.push(path_replayt(tmp_queue.front()));
+    number_of_spilled_states++;
+  }
+}
+
+/// rebuilds a batch of states from disk, until the queue uses
+/// half of its memory limit, but at least one state
+void path_searcht::reload_states(path_symex_configt &config)
+{
+  // The states that were spilled last are the ones the strategy
+  // would have picked next, unless it picks the oldest ones first.
+  const bool lifo=!queue.get_strategy().picks_oldest();
+
+  for(std::size_t count=0;
+      count<reload_batch_size &&
+      !spilled_states.empty() &&
+      (count==0 || queue.estimate_memory()<queue_memory_limit/2);
+      count++)
+  {
+    path_replayt path;
+
+    if(spilled_states.pop(path, lifo))
+      throw "failed to read states from file";
+
+    queuet tmp_queue;
+    tmp_queue.push_back(config.initial_state());
+
+    try
+    {
+      path.replay(tmp_queue.front());
+      queue.push(tmp_queue);
+      number_of_reloaded_states++;
     }
     catch(const cprover_exception_baset &e)
     {
       error() << bright_red << e.what() << reset << eom;
       number_of_dropped_states++;
     }
-    catch(const std::string &e)
+  }
+}
+
+/// Executes one step of the state at the head of 'further_states'.
+/// The successor states are left in 'further_states', which is
+/// emptied when the state is finished or dropped.
+/// \return true if the search is to stop
+bool path_searcht::execute(queuet &further_states)
+{
+  number_of_steps++;
+
+  try
+  {
+    statet &state=further_states.front();
+
+    // record we have seen it
+    loc_data[state.pc()].visited=true;
+
+    // this may change the scores of the queued states
+    queue.get_strategy().visit(state.pc());
+
+    debug() << "Loc: " << state.pc()
+            << ", queue: " << queue.size()
+            << ", depth: " << state.get_depth() << eom;
+
+    // dead already?
+    if(!state.is_executable())
     {
-      error() << bright_red << e << reset << eom;
-      number_of_dropped_states++;
+      goto_programt::const_targett pc=state.get_instruction();
+      debug() << "path is dead at "
+              << pc->source_location
+              << " thread " << state.get_current_thread()
+              << eom;
+      number_of_paths++;
+      further_states.clear();
+      return check_pending_goals();
     }
-    catch(const char *e)
+
+    // At the bound of the current iteration of iterative deepening?
+    // Then the state is continued in the next one.
+    if(deepening_depth!=0 &&
+       state.get_depth()>=depth_limit &&
+       depth_limit<deepening_max_depth)
+    {
+      frontier.push(path_replayt(state));
+      further_states.clear();
+      return false;
+    }
+
+    // drop deliberately?
+    if(drop_state(state))
     {
-      error() << bright_red << e << reset << eom;
       number_of_dropped_states++;
+      number_of_paths++;
+      further_states.clear();
+      return false;
     }
-    catch(int)
+
+    if(drop_duplicate_states && is_duplicate(state))
     {
       number_of_dropped_states++;
+      number_of_duplicate_states++;
+      number_of_paths++;
+      further_states.clear();
+      return false;
     }
-  }
 
-  report_statistics();
+    // check feasibility
+    if(eager_infeasibility && state.last_was_branch())
+    {
+      if(solver_pool!=nullptr)
+      {
+        // the state may wait for the result, see apply_solver_results
+        if(check_feasibility_async(further_states))
+          return false;
+      }
+      else
+      {
+        const tvt feasible=is_feasible(state);
 
-  return number_of_failed_properties==0?resultt::SAFE:resultt::UNSAFE;
+        if(feasible.is_false())
+        {
+          number_of_infeasible_paths++;
+          number_of_paths++;
+          further_states.clear();
+          return false;
+        }
+
+        // try again later, with more time
+        if(feasible.is_unknown() && retry_unknown &&
+           retry_round<max_retry_rounds)
+        {
+          unknown_states.splice(
+            unknown_states.end(), further_states, further_states.begin());
+          further_states.clear();
+          return false;
+        }
+      }
+    }
+
+    if(number_of_steps%10==0)
+    {
+      auto now=std::chrono::steady_clock::now();
+      if(now>=last_reported_time+std::chrono::seconds(1))
+      {
+        last_reported_time=now;
+        auto running_time=now-start_time;
+        status() << "Queue " << queue.size()
+                 << " thread " << state.get_current_thread()+1
+                 << '/' << state.threads.size()
+                 << " PC " << state.pc()
+                 << " depth " << state.get_depth()
+                 << " [" << number_of_steps << " steps, "
+                 << std::chrono::duration<double>(running_time).count()
+                 << "s]" << messaget::eom;
+      }
+    }
+
+    // an error, possibly?
+    if(state.get_instruction()->is_assert())
+    {
+      if(show_vcc)
+        do_show_vcc(state);
+      else
+      {
+        check_assertion(state);
+
+        if(stop_after_failures())
+          return true;
+      }
+    }
+
+    // execute
+    path_symex(state, further_states);
+
+    // the end of the path, or enough goals for one check
+    if(further_states.empty() ||
+       pending_goals.size()>=max_pending_goals)
+      return check_pending_goals();
+  }
+  catch(const cprover_exception_baset &e)
+  {
+    error() << bright_red << e.what() << reset << eom;
+    number_of_dropped_states++;
+    further_states.clear();
+  }
+  catch(const std::string &e)
+  {
+    error() << bright_red << e << reset << eom;
+    number_of_dropped_states++;
+    further_states.clear();
+  }
+  catch(const char *e)
+  {
+    error() << bright_red << e << reset << eom;
+    number_of_dropped_states++;
+    further_states.clear();
+  }
+  catch(int)
+  {
+    number_of_dropped_states++;
+    further_states.clear();
+  }
+
+  return false;
 }
 
-void path_searcht::report_statistics()
+void path_searcht::report_statistics(const path_symex_configt &config)
 {
   std::size_t number_of_visited_locations=0;
   for(const auto &l : loc_data)
@@ -201,6 +567,22 @@ void path_searcht::report_statistics()
   status() << "Number of dropped states: "
            << number_of_dropped_states << messaget::eom;
 
+  if(number_of_duplicate_states!=0)
+    status() << "Number of duplicate states: "
+             << number_of_duplicate_states << messaget::eom;
+
+  if(number_of_merged_states!=0)
+    status() << "Number of merged states: "
+             << number_of_merged_states << messaget::eom;
+
+  if(number_of_spilled_states!=0)
+  {
+    status() << "Number of states moved to disk: "
+             << number_of_spilled_states << messaget::eom;
+    status() << "Number of states reloaded from disk: "
+             << number_of_reloaded_states << messaget::eom;
+  }
+
   status() << "Number of paths: "
            << number_of_paths << messaget::eom;
 
@@ -212,6 +594,48 @@ void path_searcht::report_statistics()
            << " remaining after simplification"
            << messaget::eom;
 
+  if(number_of_unknown_queries!=0)
+    status() << "Number of queries beyond the time limit: "
+             << number_of_unknown_queries << messaget::eom;
+
+  if(number_of_retried_states!=0)
+    status() << "Number of retried states: "
+             << number_of_retried_states << messaget::eom;
+
+  if(number_of_sliced_constraints!=0)
+    status() << "Constraints sliced away: "
+             << number_of_sliced_constraints << " (out of "
+             << number_of_path_constraints << ')' << messaget::eom;
+
+  if(number_of_simplified_constraints!=0)
+    status() << "Constraints simplified away: "
+             << number_of_simplified_constraints << messaget::eom;
+
+  if(query_cache.number_of_queries!=0)
+    status() << "Query cache: " << query_cache.number_of_hits()
+             << " hits (" << query_cache.number_of_exact_hits
+             << " exact, " << query_cache.number_of_subset_hits
+             << " unsatisfiable subsets, "
+             << query_cache.number_of_superset_hits
+             << " satisfiable supersets, "
+             << query_cache.number_of_model_hits
+             << " recent models, "
+             << query_cache.number_of_persistent_hits
+             << " earlier runs) of "
+             << query_cache.number_of_queries << " queries, saved "
+             << query_cache.saved_time << "s" << messaget::eom;
+
+  if(query_cache.number_of_persistent_errors!=0)
+    warning() << "Failed to write " << query_cache.number_of_persistent_errors
+              << " results to the query cache" << messaget::eom;
+
+  status() << "Shared expressions: " << config.expr_pool.size()
+           << " nodes";
+  if(config.expr_pool.get_number_of_resets()!=0)
+    status() << ", pool cleared "
+             << config.expr_pool.get_number_of_resets() << " time(s)";
+  status() << messaget::eom;
+
   auto total_time=std::chrono::steady_clock::now()-start_time;
   status() << "Runtime total: "
            << std::chrono::duration<double>(total_time).count()
@@ -221,24 +645,53 @@ void path_searcht::report_statistics()
            << "s" << messaget::eom;
 }
 
-void path_searcht::pick_state()
+/// Decides whether an equivalent state has been explored before.
+/// Such a state has the same PCs, call stacks and values, and the same
+/// path constraint, and thus the same future. States are only compared
+/// where paths come together: at jump targets, and anywhere once there
+/// are several threads. Paths that split up at a branch have different
+/// guards, and are not duplicates, even if their values agree; these
+/// are combined by merging. The states with the same hash and path
+/// fingerprint are compared with the state, to confirm the match. The
+/// paths are compared by their fingerprints only, as the states seen
+/// are kept without their histories.
+bool path_searcht::is_duplicate(const statet &state)
 {
-  switch(search_heuristic)
-  {
-  case search_heuristict::DFS:
-    // Picking the first one (most recently added) is a DFS.
-    return;
+  if(state.threads.size()==1 && !state.get_instruction()->is_target())
+    return false;
 
-  case search_heuristict::BFS:
-    // Picking the last one is a BFS.
-    if(queue.size()>=2)
-      // move last to first position
-      queue.splice(queue.begin(), queue, --queue.end(), queue.end());
-    return;
+  std::size_t h=state.hash();
 
-  case search_heuristict::LOCS:
-    return;
-  }
+  // the bounds apply to counters that are not part of the hash
+  if(depth_limit!=std::numeric_limits<unsigned>::max())
+    h=hash_combine(h, state.get_depth());
+
+  if(branch_bound!=std::numeric_limits<unsigned>::max())
+    h=hash_combine(h, state.get_no_branches());
+
+  if(context_bound!=std::numeric_limits<unsigned>::max())
+    h=hash_combine(h, state.get_no_thread_interleavings());
+
+  queuet &candidates=
+    seen_states[std::make_pair(h, state.history.guard_fingerprint())];
+
+  for(const auto &candidate : candidates)
+    if(state.is_equivalent(candidate) &&
+       (depth_limit==std::numeric_limits<unsigned>::max() ||
+        state.get_depth()==candidate.get_depth()) &&
+       (branch_bound==std::numeric_limits<unsigned>::max() ||
+        state.get_no_branches()==candidate.get_no_branches()) &&
+       (context_bound==std::numeric_limits<unsigned>::max() ||
+        state.get_no_thread_interleavings()==
+          candidate.get_no_thread_interleavings()))
+      return true;
+
+  candidates.push_back(state);
+
+  // the steps of the path can be reclaimed
+  candidates.back().history=path_symex_step_reft();
+
+  return false;
 }
 
 /// decide whether to drop an overwise viable state
@@ -294,7 +747,7 @@ bool path_searcht::drop_state(const statet &state)
       << " " << source_location
       << " thread " << state.get_current_thread() << eom;
 
-    if(stop && unwinding_assertions && is_feasible(state))
+    if(stop && unwinding_assertions && is_feasible(state).is_true())
     {
       // record that failure
       status() << "Unwinding assertion failed: " << id << eom;
@@ -376,60 +829,415 @@ void path_searcht::check_assertion(statet &state)
   // keep statistics
   number_of_VCCs_after_simplification++;
 
+  if(check_goals_together())
+  {
+    pending_goalt goal;
+    goal.property_name=property_name;
+    goal.history=state.history;
+    goal.goal=not_exprt(assertion);
+    goal.pc=state.get_instruction();
+    goal.thread_nr=state.get_current_thread();
+    pending_goals.push_back(goal);
+    return;
+  }
+
   status() << "Checking property " << property_name << eom;
 
+  if(solver_pool!=nullptr)
+  {
+    check_assertion_async(state, property_name, not_exprt(assertion));
+    return;
+  }
+
   // take the time
   auto solver_start_time=std::chrono::steady_clock::now();
 
-  satcheckt satcheck(get_message_handler());
-  bv_pointerst bv_pointers(ns, satcheck, get_message_handler());
+  // is the negation of the assertion satisfiable?
+  const decision_proceduret::resultt result=
+    solve(state, not_exprt(assertion), true);
+
+  // the solver gave up
+  if(result==decision_proceduret::resultt::D_ERROR)
+    property_entry.status=UNKNOWN;
 
-  if(!state.check_assertion(bv_pointers))
+  if(result==decision_proceduret::resultt::D_SATISFIABLE)
   {
-    property_entry.error_trace=build_goto_trace(state, bv_pointers);
+    set_failure(
+      property_entry,
+      build_goto_trace(state, get_model()),
+      state.get_instruction(),
+      state.get_current_thread());
+
+    if(record_failure_paths)
+      failure_paths[property_name]=path_replayt(state);
+  }
 
-    // add the assertion
-    goto_trace_stept trace_step;
+  solver_time+=std::chrono::steady_clock::now()-solver_start_time;
+}
 
-    trace_step.pc=state.get_instruction();
-    trace_step.thread_nr=state.get_current_thread();
-    trace_step.step_nr=property_entry.error_trace.steps.size();
-    trace_step.type=goto_trace_stept::typet::ASSERT;
+/// records the failure of a property, with the trace up to the
+/// assertion, which is added
+void path_searcht::set_failure(
+  property_entryt &property_entry,
+  goto_tracet error_trace,
+  goto_programt::const_targett pc,
+  unsigned thread_nr)
+{
+  property_entry.error_trace=std::move(error_trace);
 
-    const irep_idt &comment=
-      instruction.source_location.get_comment();
+  // add the assertion
+  goto_trace_stept trace_step;
 
-    if(!comment.empty())
-      trace_step.comment=id2string(comment);
-    else
-      trace_step.comment="assertion";
+  trace_step.pc=pc;
+  trace_step.thread_nr=thread_nr;
+  trace_step.step_nr=property_entry.error_trace.steps.size();
+  trace_step.type=goto_trace_stept::typet::ASSERT;
+
+  const irep_idt &comment=pc->source_location.get_comment();
+
+  if(!comment.empty())
+    trace_step.comment=id2string(comment);
+  else
+    trace_step.comment="assertion";
+
+  property_entry.error_trace.add_step(trace_step);
+
+  property_entry.status=FAILURE;
+  number_of_failed_properties++;
+}
+
+/// Checks the goals queued by check_assertion together. The paths of
+/// the goals are added to the incremental solver once, and each goal
+/// gets a literal that holds if its path is taken and the assertion
+/// fails. The solver is then asked for any of the goals that have not
+/// failed yet, until none is satisfiable.
+/// \return true if the search is to stop
+bool path_searcht::check_pending_goals()
+{
+  if(pending_goals.empty())
+    return false;
+
+  status() << "Checking " << pending_goals.size() << " goal(s)" << eom;
+
+  auto solver_start_time=std::chrono::steady_clock::now();
+
+  bvt literals;
+  literals.reserve(pending_goals.size());
+
+  for(const auto &goal : pending_goals)
+    literals.push_back(solver->convert_goal(goal.history, goal.goal));
+
+  std::vector<std::size_t> open(pending_goals.size());
+  for(std::size_t i=0; i<open.size(); i++)
+    open[i]=i;
+
+  while(!open.empty())
+  {
+    bvt open_literals;
+    for(const auto i : open)
+      open_literals.push_back(literals[i]);
+
+    auto start=std::chrono::steady_clock::now();
+    const decision_proceduret::resultt result=
+      solver->solve_any(open_literals);
+    check_solver_result(result, std::chrono::steady_clock::now()-start);
+
+    // the goals that are open remain unknown
+    if(result==decision_proceduret::resultt::D_ERROR)
+    {
+      for(const auto i : open)
+        property_map[pending_goals[i].property_name].status=UNKNOWN;
+      break;
+    }
 
-    property_entry.error_trace.add_step(trace_step);
+    if(result!=decision_proceduret::resultt::D_SATISFIABLE)
+      break;
+
+    // the model may satisfy several goals at once
+    std::vector<std::size_t> still_open;
+
+    for(const auto i : open)
+    {
+      const pending_goalt &goal=pending_goals[i];
+      property_entryt &property_entry=property_map[goal.property_name];
+
+      if(property_entry.is_failure())
+        continue;
 
-    property_entry.status=FAILURE;
-    number_of_failed_properties++;
+      if(solver->get(literals[i]).is_true())
+        set_failure(
+          property_entry,
+          build_goto_trace(
+            goal.history, ns, solver->get_decision_procedure()),
+          goal.pc,
+          goal.thread_nr);
+      else
+        still_open.push_back(i);
+    }
+
+    // there are goals of the same property on several paths
+    open.clear();
+
+    for(const auto i : still_open)
+      if(!property_map[pending_goals[i].property_name].is_failure())
+        open.push_back(i);
   }
 
+  pending_goals.clear();
+
   solver_time+=std::chrono::steady_clock::now()-solver_start_time;
+
+  return stop_after_failures();
+}
+
+/// \return true if the search is to stop, as all properties have
+///   failed, or with stop_on_fail
+bool path_searcht::stop_after_failures() const
+{
+  if(number_of_failed_properties==0)
+    return false;
+
+  // all assertions failed?
+  if(number_of_failed_properties==property_map.size())
+    return true;
+
+  // do we stop on failure?
+  return stop_on_fail;
 }
 
-bool path_searcht::is_feasible(const statet &state)
+/// \return unknown if the solver has reached its time limit
+tvt path_searcht::is_feasible(const statet &state)
 {
   status() << "Feasibility check" << eom;
 
   // take the time
   auto solver_start_time=std::chrono::steady_clock::now();
 
-  satcheckt satcheck(get_message_handler());
-  bv_pointerst bv_pointers(ns, satcheck, get_message_handler());
-
-  bool result=state.is_feasible(bv_pointers);
+  const decision_proceduret::resultt result=solve(state, nil_exprt(), false);
 
   solver_time+=std::chrono::steady_clock::now()-solver_start_time;
 
+  if(result==decision_proceduret::resultt::D_ERROR)
+    return tvt::unknown();
+
+  return tvt(result==decision_proceduret::resultt::D_SATISFIABLE);
+}
+
+/// Checks the path constraint of the state, together with the goal,
+/// unless it is nil. Only the constraints that the goal depends on are
+/// given to the solver, and the query cache is asked first. The path
+/// is checked in full if the other constraints might be inconsistent,
+/// or if a model of the path is needed.
+/// \return D_ERROR if the solver has reached its time limit; other
+///   errors are thrown
+decision_proceduret::resultt path_searcht::solve(
+  const statet &state,
+  const exprt &goal,
+  bool need_model)
+{
+  const constraint_slicert slice(state.history, goal);
+  const constraint_simplifiert simplified(slice.constraints, goal, ns);
+  const path_queryt query(simplified.constraints, simplified.goal);
+
+  number_of_path_constraints+=slice.number_of_path_constraints;
+  number_of_sliced_constraints+=
+    slice.number_of_path_constraints-slice.constraints.size();
+
+  if(simplified.constraints.size()<slice.constraints.size())
+    number_of_simplified_constraints+=
+      slice.constraints.size()-simplified.constraints.size();
+
+  decision_proceduret::resultt result;
+  bool have_model=false;
+
+  const optionalt<bool> cached=query_cache.lookup(query, ns);
+
+  if(cached.has_value())
+    result=*cached?decision_proceduret::resultt::D_SATISFIABLE:
+                   decision_proceduret::resultt::D_UNSATISFIABLE;
+  else
+  {
+    auto start=std::chrono::steady_clock::now();
+    result=solve_slice(state, slice, simplified, goal);
+    std::chrono::duration<double> time=
+      std::chrono::steady_clock::now()-start;
+
+    check_solver_result(result, time);
+
+    if(result==decision_proceduret::resultt::D_SATISFIABLE)
+    {
+      std::vector<exprt> model;
+      model.reserve(query.symbols.size());
+
+      for(const auto &symbol : query.symbols)
+        model.push_back(get_model().get(symbol));
+
+      query_cache.insert(query, true, std::move(model), time.count());
+
+      // the incremental solver has all symbols
+      have_model=slice.is_complete() &&
+                 (solver!=nullptr || simplified.is_unchanged());
+    }
+    else if(result==decision_proceduret::resultt::D_UNSATISFIABLE)
+      query_cache.insert(query, false, {}, time.count());
+  }
+
+  if(result!=decision_proceduret::resultt::D_SATISFIABLE)
+    return result;
+
+  if(needs_full_path(state.history, slice, need_model, have_model))
+  {
+    auto start=std::chrono::steady_clock::now();
+    result=solve_path(state, goal, need_model);
+    check_solver_result(result, std::chrono::steady_clock::now()-start);
+  }
+
+  // the path up to the state is feasible
+  if(result==decision_proceduret::resultt::D_SATISFIABLE)
+    state.history->known_feasible=true;
+
   return result;
 }
 
+/// Errors of the decision procedure are thrown, unless it has reached
+/// its time limit, which leaves the result of the query unknown.
+void path_searcht::check_solver_result(
+  decision_proceduret::resultt result,
+  std::chrono::duration<double> time)
+{
+  if(result!=decision_proceduret::resultt::D_ERROR)
+    return;
+
+  if(!solver_factory.is_limit_reached(time))
+    throw "error from decision procedure";
+
+  number_of_unknown_queries++;
+}
+
+/// Decides whether a satisfiable slice needs to be confirmed by
+/// checking the full path.
+bool path_searcht::needs_full_path(
+  path_symex_step_reft history,
+  const constraint_slicert &slice,
+  bool need_model,
+  bool have_model) const
+{
+  return (need_model && !have_model) ||
+         !is_known_feasible(history, slice.last_dropped_guard);
+}
+
+/// Decides whether the path up to the given step is known to be
+/// feasible, which is the case if a step on the path, not before
+/// 'from', is.
+bool path_searcht::is_known_feasible(
+  path_symex_step_reft history,
+  path_symex_step_reft from) const
+{
+  if(from.is_nil())
+    return true;
+
+  for(; !history.is_nil() && !from.is_after(history); --history)
+    if(history->known_feasible)
+      return true;
+
+  return false;
+}
+
+/// Checks the constraints of the slice, together with the goal. The
+/// decision procedures that are not incremental are given the
+/// simplified constraints.
+decision_proceduret::resultt path_searcht::solve_slice(
+  const statet &state,
+  const constraint_slicert &slice,
+  const constraint_simplifiert &simplified,
+  const exprt &goal)
+{
+  if(simplified.is_false())
+    return decision_proceduret::resultt::D_UNSATISFIABLE;
+
+  // the incremental solver has all assignments,
+  // and is given the guards of the slice only
+  if(solver!=nullptr)
+    return (*solver)(state, slice.guards, goal);
+
+  query_solver=solver_factory(get_message_handler());
+
+  decision_proceduret &decision_procedure=
+    query_solver->decision_procedure();
+
+  for(const auto &c : simplified.constraints)
+    decision_procedure.set_to_true(c);
+
+  if(simplified.goal.is_not_nil())
+    decision_procedure.set_to_true(simplified.goal);
+
+  return decision_procedure();
+}
+
+/// Checks the full path constraint of the state, together with the
+/// goal. Decision procedures that are not incremental are created
+/// afresh, and are given the simplified path constraint unless the
+/// model is needed.
+decision_proceduret::resultt path_searcht::solve_path(
+  const statet &state,
+  const exprt &goal,
+  bool need_model)
+{
+  if(solver!=nullptr)
+    return (*solver)(state, goal);
+
+  if(need_model)
+  {
+    query_solver=solver_factory(get_message_handler());
+
+    decision_proceduret &decision_procedure=
+      query_solver->decision_procedure();
+
+    decision_procedure << state.history;
+
+    if(goal.is_not_nil())
+      decision_procedure.set_to_true(goal);
+
+    return decision_procedure();
+  }
+
+  std::vector<path_symex_step_reft> steps;
+  state.history.build_history(steps);
+
+  std::vector<exprt> constraints;
+
+  for(const auto &s : steps)
+    s->get_constraints(constraints);
+
+  const constraint_simplifiert simplified(constraints, goal, ns);
+
+  if(simplified.is_false())
+    return decision_proceduret::resultt::D_UNSATISFIABLE;
+
+  query_solver=solver_factory(get_message_handler());
+
+  decision_proceduret &decision_procedure=
+    query_solver->decision_procedure();
+
+  for(const auto &c : simplified.constraints)
+    decision_procedure.set_to_true(c);
+
+  if(simplified.goal.is_not_nil())
+    decision_procedure.set_to_true(simplified.goal);
+
+  return decision_procedure();
+}
+
+/// the model of the last satisfiable query
+const decision_proceduret &path_searcht::get_model() const
+{
+  if(solver!=nullptr)
+    return solver->get_decision_procedure();
+
+  PRECONDITION(query_solver!=nullptr);
+  return query_solver->decision_procedure();
+}
+
 void path_searcht::initialize_property_map(
   const goto_functionst &goto_functions)
 {
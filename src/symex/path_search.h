@@ -15,12 +15,24 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <chrono>
 
 #include <util/expanding_vector.h>
+#include <util/threeval.h>
 
 #include <goto-programs/safety_checker.h>
 
+#include <path-symex/path_replay.h>
 #include <path-symex/path_symex_state.h>
 
 #include <limits>
+#include <map>
+
+#include "constraint_simplifier.h"
+#include "constraint_slicer.h"
+#include "incremental_solver.h"
+#include "query_cache.h"
+#include "search_strategy.h"
+#include "solver_factory.h"
+#include "solver_pool.h"
+#include "spilled_states.h"
 
 class path_searcht:public safety_checkert
 {
@@ -31,7 +43,12 @@ public:
     eager_infeasibility(false),
     stop_on_fail(false),
     unwinding_assertions(false),
+    multi_goal(false),
+    retry_unknown(false),
+    drop_duplicate_states(false),
+    solver_factory(_ns),
     number_of_dropped_states(0),
+    number_of_duplicate_states(0),
     number_of_paths(0),
     number_of_steps(0),
     number_of_feasible_paths(0),
@@ -45,7 +62,30 @@ public:
     branch_bound(std::numeric_limits<unsigned>::max()),
     unwind_limit(std::numeric_limits<unsigned>::max()),
     time_limit(std::numeric_limits<unsigned>::max()),
-    search_heuristic(search_heuristict::DFS)
+    fork_workers(0),
+    solver_threads(0),
+    search_strategy("dfs"),
+    seed(0),
+    queue_memory_limit(std::numeric_limits<std::size_t>::max()),
+    number_of_spilled_states(0),
+    number_of_reloaded_states(0),
+    merge_states(false),
+    merge_limit(0),
+    number_of_merged_states(0),
+    retry_round(0),
+    number_of_unknown_queries(0),
+    number_of_retried_states(0),
+    number_of_path_constraints(0),
+    number_of_sliced_constraints(0),
+    number_of_simplified_constraints(0),
+    deepening_depth(0),
+    deepening_factor(2),
+    deepening_max_depth(0),
+    stop_search(false),
+    work_request_fd(-1),
+    result_fd(-1),
+    next_async_query(0),
+    record_failure_paths(false)
   {
   }
 
@@ -77,13 +117,41 @@ public:
     time_limit=limit;
   }
 
+  // number of worker processes
+  void set_fork_workers(unsigned _fork_workers)
+  {
+    fork_workers=_fork_workers;
+  }
+
+  // number of threads that solve queries while the search goes on
+  void set_solver_threads(unsigned _solver_threads)
+  {
+    solver_threads=_solver_threads;
+  }
+
   bool show_vcc;
   bool eager_infeasibility;
   bool stop_on_fail;
   bool unwinding_assertions;
 
+  // check the assertions of a path together, which pays off when
+  // most of them are expected to fail, as with --cover
+  bool multi_goal;
+
+  // States whose feasibility is unknown as the solver has reached its
+  // time limit are explored once the others are done, with a larger
+  // limit. Otherwise, they are explored as if feasible.
+  bool retry_unknown;
+
+  // drop the states that have been explored before
+  bool drop_duplicate_states;
+
+  // the decision procedure for the queries
+  solver_factoryt solver_factory;
+
   // statistics
   std::size_t number_of_dropped_states;
+  std::size_t number_of_duplicate_states;
   std::size_t number_of_paths;
   std::size_t number_of_steps;
   std::size_t number_of_feasible_paths;
@@ -94,9 +162,11 @@ public:
   std::size_t number_of_locs;
 
   std::chrono::time_point<std::chrono::steady_clock> start_time;
+  std::chrono::time_point<std::chrono::steady_clock> last_reported_time;
   std::chrono::duration<double> solver_time;
 
-  enum statust { NOT_REACHED, SUCCESS, FAILURE };
+  // UNKNOWN: the solver has reached its time limit
+  enum statust { NOT_REACHED, SUCCESS, FAILURE, UNKNOWN };
 
   struct property_entryt
   {
@@ -108,11 +178,62 @@ public:
     bool is_success() const { return status==SUCCESS; }
     bool is_failure() const { return status==FAILURE; }
     bool is_not_reached() const { return status==NOT_REACHED; }
+    bool is_unknown() const { return status==UNKNOWN; }
   };
 
-  void set_dfs() { search_heuristic=search_heuristict::DFS; }
-  void set_bfs() { search_heuristic=search_heuristict::BFS; }
-  void set_locs() { search_heuristic=search_heuristict::LOCS; }
+  void set_dfs() { search_strategy="dfs"; }
+  void set_bfs() { search_strategy="bfs"; }
+  void set_locs() { search_strategy="locs"; }
+  void set_random_path() { search_strategy="random-path"; }
+
+  // directed search towards the given lines and properties
+  void add_target_line(const std::string &file, unsigned line)
+  {
+    target_lines.push_back(std::make_pair(file, line));
+  }
+
+  void add_target_property(const irep_idt &property)
+  {
+    target_properties.push_back(property);
+  }
+  void set_seed(unsigned _seed) { seed=_seed; }
+
+  // explore up to depth d, then d*k, d*k*k, and so on,
+  // until the depth limit is reached
+  void set_iterative_deepening(unsigned d, unsigned k)
+  {
+    deepening_depth=d;
+    deepening_factor=k<2?2:k;
+  }
+
+  // Merges the states that meet at a join point, if at most 'limit'
+  // variables differ; the default search is then topological.
+  void set_merge_states(std::size_t limit)
+  {
+    merge_states=true;
+    merge_limit=limit;
+  }
+
+  // beyond this, queued states are moved to disk
+  void set_queue_memory_limit(std::size_t megabytes)
+  {
+    queue_memory_limit=megabytes<<20;
+  }
+
+  // the results of the queries are kept in this directory, too
+  void set_query_cache_directory(const std::string &directory)
+  {
+    query_cache_directory=directory;
+  }
+
+  // see new_search_strategy for the names; returns true on error
+  bool set_search_strategy(const std::string &name)
+  {
+    if(new_search_strategy(name)==nullptr)
+      return true;
+    search_strategy=name;
+    return false;
+  }
 
   void set_unwinding_assertions(bool _unwinding_assertions)
   {
@@ -125,13 +246,10 @@ public:
 protected:
   typedef path_symex_statet statet;
 
-  // State queue. Iterators are stable.
-  // The states most recently executed are at the head.
-  typedef std::list<statet> queuet;
-  queuet queue;
+  typedef state_queuet::queuet queuet;
 
-  // search heuristic
-  void pick_state();
+  // State queue, ordered by the search strategy.
+  state_queuet queue;
 
   struct loc_datat
   {
@@ -141,12 +259,83 @@ protected:
 
   std::map<loc_reft, loc_datat> loc_data;
 
-  bool execute(queuet::iterator state);
+  // the solver for all queries of the search, if the decision
+  // procedure is incremental, and otherwise the one of the last query
+  std::unique_ptr<incremental_solvert> solver;
+  std::unique_ptr<solver_factoryt::solvert> query_solver;
+
+  // the results of earlier queries
+  query_cachet query_cache;
+  std::string query_cache_directory;
+
+  decision_proceduret::resultt solve(
+    const statet &,
+    const exprt &goal,
+    bool need_model);
+  decision_proceduret::resultt solve_slice(
+    const statet &,
+    const constraint_slicert &,
+    const constraint_simplifiert &,
+    const exprt &goal);
+  decision_proceduret::resultt solve_path(
+    const statet &,
+    const exprt &goal,
+    bool need_model);
+
+  void check_solver_result(
+    decision_proceduret::resultt,
+    std::chrono::duration<double> time);
+  bool needs_full_path(
+    path_symex_step_reft history,
+    const constraint_slicert &,
+    bool need_model,
+    bool have_model) const;
+
+  // the last steps of the paths that have been found to be feasible
+  // are marked, see path_symex_stept::known_feasible
+  bool is_known_feasible(
+    path_symex_step_reft history,
+    path_symex_step_reft from) const;
+
+  const decision_proceduret &get_model() const;
+
+  bool execute(queuet &further_states);
   void check_assertion(statet &);
-  bool is_feasible(const statet &);
+  void set_failure(
+    property_entryt &,
+    goto_tracet error_trace,
+    goto_programt::const_targett pc,
+    unsigned thread_nr);
+
+  // the assertions that check_assertion has queued, with multi_goal
+  struct pending_goalt
+  {
+    irep_idt property_name;
+    path_symex_step_reft history;
+    exprt goal;
+    goto_programt::const_targett pc;
+    unsigned thread_nr;
+  };
+
+  std::vector<pending_goalt> pending_goals;
+  bool check_pending_goals();
+  bool stop_after_failures() const;
+
+  // the pending goals are checked at the latest with this many
+  static const std::size_t max_pending_goals=64;
+
+  // the worker processes report the paths to the failures,
+  // and need a state for those
+  bool check_goals_together() const
+  {
+    return multi_goal && solver!=nullptr && fork_workers==0;
+  }
+
+  tvt is_feasible(const statet &);
   void do_show_vcc(statet &);
   bool drop_state(const statet &);
-  void report_statistics();
+  bool is_duplicate(const statet &);
+  void report_statistics(const path_symex_configt &);
   void initialize_property_map(const goto_functionst &);
 
   unsigned depth_limit;
@@ -154,10 +343,138 @@ protected:
   unsigned branch_bound;
   unsigned unwind_limit;
   unsigned time_limit;
-
-  enum class search_heuristict { DFS, BFS, LOCS } search_heuristic;
+  unsigned fork_workers;
+  unsigned solver_threads;
+
+  std::string search_strategy;
+  unsigned seed;
+
+  // for the directed search
+  std::vector<std::pair<std::string, unsigned>> target_lines;
+  std::vector<irep_idt> target_properties;
+  void set_up_strategy(const goto_functionst &);
+  void clear_states();
+
+  // the states moved to disk when the queue exceeds its memory limit
+  std::size_t queue_memory_limit;
+  spilled_statest spilled_states;
+  std::size_t number_of_spilled_states;
+  std::size_t number_of_reloaded_states;
+  void spill_states();
+  void reload_states(path_symex_configt &);
+
+  // at most this many states are rebuilt at once
+  static const std::size_t reload_batch_size=256;
+
+  // The states seen at join points, for drop_duplicate_states, by
+  // their hashes and path fingerprints. The states are kept without
+  // their histories, which would keep the steps of their paths alive.
+  std::map<std::pair<std::size_t, std::size_t>, queuet> seen_states;
+
+  // merging of states at join points
+  bool merge_states;
+  std::size_t merge_limit;
+  std::size_t number_of_merged_states;
+  void merge_queued_states(statet &);
+
+  // the states whose feasibility is unknown, for retry_unknown
+  queuet unknown_states;
+  unsigned retry_round;
+  std::size_t number_of_unknown_queries;
+  std::size_t number_of_retried_states;
+  void retry_unknown_states();
+
+  // the time limit grows by this factor with every round
+  static const unsigned max_retry_rounds=3;
+  static const unsigned retry_factor=4;
+
+  // the constraints of the paths of the queries, and how many
+  // of them were not in the slices given to the solver
+  std::size_t number_of_path_constraints;
+  std::size_t number_of_sliced_constraints;
+
+  // how many constraints of the slices were simplified away
+  std::size_t number_of_simplified_constraints;
+
+  // iterative deepening: the states at the bound of the current
+  // iteration, which are continued in the next one
+  unsigned deepening_depth, deepening_factor;
+  unsigned deepening_max_depth;
+  spilled_statest frontier;
+  void iterative_deepening_search(path_symex_configt &);
 
   source_locationt last_source_location;
+
+  bool stop_search;
+
+  void sequential_search(path_symex_configt &);
+
+  // --fork-workers: the search is split up into subtrees that are
+  // explored by child processes, which report back over pipes
+  void fork_search(path_symex_configt &);
+  int work_request_fd, result_fd;
+  void fork_worker_poll();
+  void run_fork_worker(
+    path_symex_configt &,
+    const path_replayt *path=nullptr);
+  void fork_worker_search(path_symex_configt &);
+
+  // --solver-threads: the queries are solved by a pool of threads.
+  // A state that waits for a feasibility check is parked in its
+  // query; the state of an assertion check goes on.
+  std::unique_ptr<solver_poolt> solver_pool;
+
+  struct async_queryt
+  {
+    async_queryt(
+      path_symex_step_reft _history,
+      const exprt &_goal,
+      const namespacet &ns):
+      history(_history),
+      goal(_goal),
+      need_model(false),
+      thread_nr(0),
+      slice(new constraint_slicert(_history, _goal)),
+      simplified(new constraint_simplifiert(slice->constraints, _goal, ns)),
+      query(new path_queryt(simplified->constraints, simplified->goal)),
+      full_path(false)
+    {
+    }
+
+    path_symex_step_reft history;
+    exprt goal;
+    bool need_model;
+
+    queuet parked_state;
+
+    // for assertions
+    irep_idt property_name;
+    goto_programt::const_targett pc;
+    unsigned thread_nr;
+
+    // the slice is solved first, simplified, and then possibly
+    // the full path
+    std::unique_ptr<constraint_slicert> slice;
+    std::unique_ptr<constraint_simplifiert> simplified;
+    std::unique_ptr<path_queryt> query;
+    bool full_path;
+  };
+
+  std::map<std::size_t, async_queryt> async_queries;
+  std::size_t next_async_query;
+
+  bool check_feasibility_async(queuet &further_states);
+  void check_assertion_async(
+    statet &,
+    const irep_idt &property_name,
+    const exprt &goal);
+  optionalt<bool> start_async_query(async_queryt &);
+  void submit_async_query(std::size_t id, const async_queryt &);
+  bool apply_solver_results(bool wait);
+
+  // the paths to the failed assertions, for the worker processes
+  bool record_failure_paths;
+  std::map<irep_idt, path_replayt> failure_paths;
 };
 
 #endif // CPROVER_SYMEX_PATH_SEARCH_H
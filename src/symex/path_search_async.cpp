@@ -0,0 +1,242 @@
+/*******************************************************************\
+
+Module: Path-based Symbolic Execution with Solver Threads
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Path-based Symbolic Execution with Solver Threads
+
+#include "path_search.h"
+
+#include <path-symex/build_goto_trace.h>
+
+/// Starts the feasibility check of the state at the front, which has
+/// just branched. Unless the result is known right away, the state is
+/// parked until the result arrives.
+/// \return true if the state has been parked, or dropped
+bool path_searcht::check_feasibility_async(queuet &further_states)
+{
+  status() << "Feasibility check" << eom;
+
+  async_queryt query(further_states.front().history, nil_exprt(), ns);
+  query.parked_state.splice(
+    query.parked_state.end(), further_states, further_states.begin());
+
+  const optionalt<bool> result=start_async_query(query);
+
+  if(!result.has_value())
+  {
+    further_states.clear();
+    return true;
+  }
+
+  if(!*result)
+  {
+    number_of_infeasible_paths++;
+    number_of_paths++;
+    further_states.clear();
+    return true;
+  }
+
+  further_states.splice(further_states.begin(), query.parked_state);
+  return false;
+}
+
+/// Starts the check of an assertion, whose state goes on right away.
+void path_searcht::check_assertion_async(
+  statet &state,
+  const irep_idt &property_name,
+  const exprt &goal)
+{
+  async_queryt query(state.history, goal, ns);
+  query.need_model=true;
+  query.property_name=property_name;
+  query.pc=state.get_instruction();
+  query.thread_nr=state.get_current_thread();
+
+  const optionalt<bool> result=start_async_query(query);
+
+  // the trace needs a model, and is never known right away
+  INVARIANT(
+    !result.has_value() || !*result,
+    "failed assertions are checked by the solver threads");
+}
+
+/// Answers the query from the query cache, if possible, and otherwise
+/// hands it to the solver threads.
+/// \return the result, if known right away
+optionalt<bool> path_searcht::start_async_query(async_queryt &query)
+{
+  if(query.simplified->is_false())
+    return false;
+
+  const optionalt<bool> cached=query_cache.lookup(*query.query, ns);
+
+  if(cached.has_value())
+  {
+    if(!*cached)
+      return false;
+
+    if(!needs_full_path(query.history, *query.slice, query.need_model, false))
+    {
+      query.history->known_feasible=true;
+      return true;
+    }
+
+    query.full_path=true;
+  }
+
+  const std::size_t id=next_async_query++;
+  submit_async_query(id, query);
+  async_queries.emplace(id, std::move(query));
+
+  return {};
+}
+
+/// Converts the constraints of the query, which are then solved by
+/// one of the solver threads.
+void path_searcht::submit_async_query(
+  std::size_t id,
+  const async_queryt &query)
+{
+  auto start=std::chrono::steady_clock::now();
+
+  solver_poolt::job_ptrt job(new solver_poolt::jobt());
+  job->id=id;
+  job->solver=solver_factory(job->message_handler, false);
+
+  decision_proceduret &decision_procedure=
+    job->solver->decision_procedure();
+
+  if(query.full_path)
+    decision_procedure << query.history;
+  else
+    for(const auto &c : query.simplified->constraints)
+      decision_procedure.set_to_true(c);
+
+  const exprt &goal=query.full_path?query.goal:query.simplified->goal;
+
+  if(goal.is_not_nil())
+    decision_procedure.set_to_true(goal);
+
+  job->solver->finish_conversion();
+
+  solver_time+=std::chrono::steady_clock::now()-start;
+
+  solver_pool->submit(std::move(job));
+}
+
+/// Applies the results of the solver threads: parked states are queued
+/// again, or dropped if infeasible, and failed assertions are recorded.
+/// Satisfiable slices may need the full path to be checked, which is
+/// submitted again. A query beyond the time limit leaves the property
+/// unknown, or the state is treated as in the search thread.
+/// \param wait: wait for a result if none is there
+/// \return true if the search is to stop
+bool path_searcht::apply_solver_results(bool wait)
+{
+  std::vector<solver_poolt::job_ptrt> jobs;
+  solver_pool->get_finished(jobs, wait);
+
+  for(auto &job : jobs)
+  {
+    solver_time+=job->solver_time;
+
+    const auto q_it=async_queries.find(job->id);
+    INVARIANT(q_it!=async_queries.end(), "finished job has a query");
+    async_queryt &query=q_it->second;
+
+    const decision_proceduret &model=job->solver->decision_procedure();
+
+    if(job->result==decision_proceduret::resultt::D_ERROR)
+    {
+      // as in the search thread, this throws unless the
+      // solver has reached its time limit
+      check_solver_result(job->result, job->solver_time);
+
+      if(!query.parked_state.empty())
+      {
+        // try again later, with more time, or go on
+        if(retry_unknown && retry_round<max_retry_rounds)
+          unknown_states.splice(unknown_states.end(), query.parked_state);
+        else
+          queue.push(query.parked_state);
+      }
+      else
+      {
+        property_entryt &property_entry=property_map[query.property_name];
+
+        if(!property_entry.is_failure())
+          property_entry.status=UNKNOWN;
+      }
+
+      async_queries.erase(q_it);
+      continue;
+    }
+
+    const bool satisfiable=
+      job->result==decision_proceduret::resultt::D_SATISFIABLE;
+
+    if(!query.full_path)
+    {
+      std::vector<exprt> values;
+
+      if(satisfiable)
+        for(const auto &symbol : query.query->symbols)
+          values.push_back(model.get(symbol));
+
+      query_cache.insert(
+        *query.query,
+        satisfiable,
+        std::move(values),
+        job->solver_time.count());
+
+      if(satisfiable &&
+         needs_full_path(
+           query.history,
+           *query.slice,
+           query.need_model,
+           query.slice->is_complete() &&
+             query.simplified->is_unchanged()))
+      {
+        query.full_path=true;
+        submit_async_query(job->id, query);
+        continue;
+      }
+    }
+
+    if(satisfiable)
+      query.history->known_feasible=true;
+
+    if(!query.parked_state.empty())
+    {
+      // a feasibility check
+      if(satisfiable)
+        queue.push(query.parked_state);
+      else
+      {
+        number_of_infeasible_paths++;
+        number_of_paths++;
+      }
+    }
+    else if(satisfiable)
+    {
+      property_entryt &property_entry=property_map[query.property_name];
+
+      // the assertion may have failed on some other path meanwhile
+      if(!property_entry.is_failure())
+        set_failure(
+          property_entry,
+          build_goto_trace(query.history, ns, model),
+          query.pc,
+          query.thread_nr);
+    }
+
+    async_queries.erase(q_it);
+  }
+
+  return stop_after_failures();
+}
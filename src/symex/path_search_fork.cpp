@@ -0,0 +1,631 @@
+/*******************************************************************\
+
+Module: Path-based Symbolic Execution
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Path-based Symbolic Execution, using worker processes
+///
+/// The parent process hands queued states to child processes created
+/// with fork(), which inherit the goto program, the history forest and
+/// the states by copy-on-write. Every child explores its subtrees
+/// sequentially, and reports back over a pipe, one message per line:
+///
+///   P id          property 'id' holds on the paths explored
+///   U id          the solver gave up on property 'id'
+///   F id path     property 'id' fails on the given path
+///   W path        a queued state given back to the parent
+///   N             no state to give back
+///   L f n         location 'n' of function 'f' was visited
+///   S ...         the statistics of the child
+///
+/// Paths are given as branch decisions (see path_replayt). When a child
+/// finishes early, the parent asks the others for queued states, and
+/// starts a new child that replays the path to such a state.
+/// The error traces are rebuilt by the parent by replaying the path.
+
+#include "path_search.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <path-symex/path_symex.h>
+
+#ifdef _WIN32
+
+void path_searcht::fork_search(path_symex_configt &config)
+{
+  warning() << "--fork-workers is not supported on this platform" << eom;
+  sequential_search(config);
+}
+
+void path_searcht::fork_worker_poll()
+{
+}
+
+void path_searcht::run_fork_worker(
+  path_symex_configt &,
+  const path_replayt *)
+{
+}
+
+void path_searcht::fork_worker_search(path_symex_configt &)
+{
+}
+
+#else
+
+/// writes all of 'data' to 'fd', returns true on error
+static bool write_all(int fd, const std::string &data)
+{
+  const char *p=data.data();
+  std::size_t left=data.size();
+
+  while(left>0)
+  {
+    ssize_t result=write(fd, p, left);
+
+    if(result<0)
+    {
+      if(errno==EINTR)
+        continue;
+      return true;
+    }
+
+    p+=result;
+    left-=result;
+  }
+
+  return false;
+}
+
+struct fork_workert
+{
+  pid_t pid;
+  int result_fd;  // child to parent
+  int request_fd; // parent to child
+  std::string buffer;
+  bool request_pending;
+  std::chrono::time_point<std::chrono::steady_clock> last_refusal;
+
+  fork_workert():
+    pid(-1),
+    result_fd(-1),
+    request_fd(-1),
+    request_pending(false)
+  {
+  }
+};
+
+typedef std::list<fork_workert> fork_workerst;
+
+/// Forks a new worker process. Returns true in the child.
+static bool spawn_fork_worker(
+  fork_workerst &workers,
+  int &child_request_fd,
+  int &child_result_fd)
+{
+  int result_pipe[2], request_pipe[2];
+
+  if(pipe(result_pipe)!=0)
+    throw "failed to create pipe";
+
+  if(pipe(request_pipe)!=0)
+  {
+    close(result_pipe[0]);
+    close(result_pipe[1]);
+    throw "failed to create pipe";
+  }
+
+  // don't duplicate buffered output
+  std::cout.flush();
+  std::cerr.flush();
+
+  pid_t pid=fork();
+
+  if(pid<0)
+  {
+    close(result_pipe[0]);
+    close(result_pipe[1]);
+    close(request_pipe[0]);
+    close(request_pipe[1]);
+    throw "failed to fork worker process";
+  }
+
+  if(pid==0)
+  {
+    // the child doesn't talk to its siblings
+    for(const auto &w : workers)
+    {
+      close(w.result_fd);
+      close(w.request_fd);
+    }
+
+    close(result_pipe[0]);
+    close(request_pipe[1]);
+    child_result_fd=result_pipe[1];
+    child_request_fd=request_pipe[0];
+    return true;
+  }
+
+  close(result_pipe[1]);
+  close(request_pipe[0]);
+
+  workers.push_back(fork_workert());
+  workers.back().pid=pid;
+  workers.back().result_fd=result_pipe[0];
+  workers.back().request_fd=request_pipe[1];
+
+  return false;
+}
+
+/// runs a worker in the child process, on the queued states or on
+/// the state at the end of 'path', if given; this does not return,
+/// as the child must not go on with the code of the parent
+void path_searcht::run_fork_worker(
+  path_symex_configt &config,
+  const path_replayt *path)
+{
+  try
+  {
+    if(path!=nullptr)
+    {
+      queue.clear();
+
+      try
+      {
+        queuet tmp_queue;
+        tmp_queue.push_back(config.initial_state());
+        path->replay(tmp_queue.front());
+        queue.push(tmp_queue);
+      }
+      catch(const cprover_exception_baset &e)
+      {
+        error() << e.what() << eom;
+        number_of_dropped_states++;
+      }
+    }
+
+    fork_worker_search(config);
+  }
+  catch(const cprover_exception_baset &e)
+  {
+    error() << "worker process: " << e.what() << eom;
+  }
+  catch(const std::string &e)
+  {
+    error() << "worker process: " << e << eom;
+  }
+  catch(const char *e)
+  {
+    error() << "worker process: " << e << eom;
+  }
+  catch(const std::exception &e)
+  {
+    error() << "worker process: " << e.what() << eom;
+  }
+  catch(...)
+  {
+    error() << "worker process: unexpected exception" << eom;
+  }
+
+  // the parent sees the exit status
+  std::cout.flush();
+  std::cerr.flush();
+  _exit(1);
+}
+
+/// explores the queued states, and then reports to the parent;
+/// this is run in the child process and does not return
+void path_searcht::fork_worker_search(path_symex_configt &config)
+{
+  signal(SIGPIPE, SIG_IGN);
+
+  // the parent does the reporting
+  get_message_handler().set_verbosity(messaget::M_WARNING);
+
+  // we report the delta to the parent
+  number_of_dropped_states=0;
+  number_of_paths=0;
+  number_of_steps=0;
+  number_of_feasible_paths=0;
+  number_of_infeasible_paths=0;
+  number_of_VCCs=0;
+  number_of_VCCs_after_simplification=0;
+  solver_time=std::chrono::duration<double>(0);
+  loc_data.clear();
+
+  record_failure_paths=true;
+  failure_paths.clear();
+
+  sequential_search(config);
+
+  // remaining failures
+  fork_worker_poll();
+
+  std::ostringstream out;
+
+  for(const auto &p : property_map)
+    if(p.second.is_success())
+      out << "P " << p.first << '\n';
+    else if(p.second.is_unknown())
+      out << "U " << p.first << '\n';
+
+  for(const auto &l : loc_data)
+    if(l.second.visited)
+      out << "L " << l.first.function_identifier << ' '
+          << l.first.target->location_number << '\n';
+
+  out << "S " << number_of_dropped_states
+      << ' ' << number_of_paths
+      << ' ' << number_of_steps
+      << ' ' << number_of_feasible_paths
+      << ' ' << number_of_infeasible_paths
+      << ' ' << number_of_VCCs
+      << ' ' << number_of_VCCs_after_simplification
+      << ' ' << solver_time.count()
+      << '\n';
+
+  write_all(result_fd, out.str());
+
+  std::cout.flush();
+  _exit(0);
+}
+
+/// reports failures, and serves requests for work;
+/// this is run in the child process
+void path_searcht::fork_worker_poll()
+{
+  // report failures right away, the parent may stop the search
+  if(!failure_paths.empty())
+  {
+    std::ostringstream out;
+
+    for(const auto &f : failure_paths)
+    {
+      out << "F " << f.first << ' ';
+      f.second.output(out);
+      out << '\n';
+    }
+
+    failure_paths.clear();
+    write_all(result_fd, out.str());
+  }
+
+  if(work_request_fd==-1 || number_of_steps%16!=0)
+    return;
+
+  pollfd pfd;
+  pfd.fd=work_request_fd;
+  pfd.events=POLLIN;
+  pfd.revents=0;
+
+  if(poll(&pfd, 1, 0)<=0)
+    return;
+
+  char request;
+  if(read(work_request_fd, &request, 1)!=1)
+  {
+    // the parent is gone
+    close(work_request_fd);
+    work_request_fd=-1;
+    return;
+  }
+
+  // Give away a state from disk, which is not needed soon, or
+  // the state that has been queued for longest, which typically
+  // has the largest subtree.
+  path_replayt path;
+
+  if(!spilled_states.empty())
+  {
+    if(spilled_states.pop(path, false))
+      throw "failed to read states from file";
+  }
+  else if(queue.size()>=2)
+  {
+    queuet donated;
+    queue.pop_oldest(donated);
+    path=path_replayt(donated.front());
+  }
+  else
+  {
+    write_all(result_fd, "N\n");
+    return;
+  }
+
+  std::ostringstream out;
+  out << "W ";
+  path.output(out);
+  out << '\n';
+
+  write_all(result_fd, out.str());
+}
+
+/// explores the states in 'queue' using child processes
+void path_searcht::fork_search(path_symex_configt &config)
+{
+  // explore up front until there is a state for every worker
+  while(!queue.empty() && queue.size()<fork_workers)
+  {
+    queuet tmp_queue;
+    queue.pop(tmp_queue);
+
+    if(execute(tmp_queue))
+      return;
+
+    queue.push(tmp_queue);
+  }
+
+  if(queue.empty())
+    return;
+
+  status() << "Exploring with " << fork_workers
+           << " worker processes" << eom;
+
+  fork_workerst workers;
+  std::list<path_replayt> pending_work;
+
+  // the initial distribution uses the states inherited via fork
+  const std::size_t initial_workers=queue.size()<fork_workers?
+    queue.size():fork_workers;
+
+  for(std::size_t i=0; i<initial_workers; i++)
+  {
+    if(spawn_fork_worker(workers, work_request_fd, result_fd))
+    {
+      // keep every initial_workers-th state, starting with the i-th
+      std::size_t nr=0;
+      for(auto it=queue.begin(); it!=queue.end(); nr++)
+      {
+        if(nr%initial_workers==i)
+          ++it;
+        else
+          it=queue.erase(it);
+      }
+
+      run_fork_worker(config);
+    }
+  }
+
+  queue.clear();
+
+  std::size_t number_of_forks=initial_workers;
+
+  // parse the reports of the workers
+  auto process_line=[&](fork_workert &w, const std::string &line)
+  {
+    std::istringstream in(line);
+    std::string kind;
+    in >> kind;
+
+    if(kind=="P")
+    {
+      std::string id;
+      in >> id;
+      auto p_it=property_map.find(id);
+      if(p_it!=property_map.end() && p_it->second.is_not_reached())
+        p_it->second.status=SUCCESS;
+    }
+    else if(kind=="U")
+    {
+      std::string id;
+      in >> id;
+      auto p_it=property_map.find(id);
+      if(p_it!=property_map.end() && !p_it->second.is_failure())
+        p_it->second.status=UNKNOWN;
+    }
+    else if(kind=="F")
+    {
+      std::string id;
+      path_replayt path;
+      in >> id;
+
+      if(path.input(in))
+        throw "failed to read path from worker process";
+
+      auto p_it=property_map.find(id);
+      if(p_it==property_map.end() || p_it->second.is_failure())
+        return;
+
+      // rebuild the error trace
+      statet state=config.initial_state();
+      path.replay(state);
+
+      // the child has counted the VCC already
+      const std::size_t VCCs=number_of_VCCs;
+      const std::size_t VCCs_after_simplification=
+        number_of_VCCs_after_simplification;
+
+      check_assertion(state);
+
+      number_of_VCCs=VCCs;
+      number_of_VCCs_after_simplification=VCCs_after_simplification;
+
+      if(number_of_failed_properties==property_map.size() ||
+         (number_of_failed_properties>=1 && stop_on_fail))
+        stop_search=true;
+    }
+    else if(kind=="W")
+    {
+      path_replayt path;
+      if(path.input(in))
+        throw "failed to read path from worker process";
+      pending_work.push_back(path);
+      w.request_pending=false;
+    }
+    else if(kind=="N")
+    {
+      w.request_pending=false;
+      w.last_refusal=std::chrono::steady_clock::now();
+    }
+    else if(kind=="L")
+    {
+      std::string function;
+      unsigned location_number;
+      in >> function >> location_number;
+
+      auto f_it=config.goto_functions.function_map.find(function);
+      if(f_it==config.goto_functions.function_map.end() ||
+         f_it->second.body.instructions.empty())
+        return;
+
+      // location numbers are consecutive within a function
+      const auto &instructions=f_it->second.body.instructions;
+      const unsigned first=instructions.begin()->location_number;
+      if(location_number<first ||
+         location_number-first>=instructions.size())
+        return;
+
+      auto target=std::next(instructions.begin(), location_number-first);
+      loc_data[loc_reft(function, target)].visited=true;
+    }
+    else if(kind=="S")
+    {
+      std::size_t dropped, paths, steps, feasible, infeasible,
+                  VCCs, VCCs_after_simplification;
+      double time;
+
+      in >> dropped >> paths >> steps >> feasible >> infeasible
+         >> VCCs >> VCCs_after_simplification >> time;
+
+      number_of_dropped_states+=dropped;
+      number_of_paths+=paths;
+      number_of_steps+=steps;
+      number_of_feasible_paths+=feasible;
+      number_of_infeasible_paths+=infeasible;
+      number_of_VCCs+=VCCs;
+      number_of_VCCs_after_simplification+=VCCs_after_simplification;
+      solver_time+=std::chrono::duration<double>(time);
+    }
+  };
+
+  bool killed=false;
+
+  while(!workers.empty())
+  {
+    if(stop_search && !killed)
+    {
+      for(const auto &w : workers)
+        kill(w.pid, SIGTERM);
+      pending_work.clear();
+      killed=true;
+    }
+
+    // start new workers for the states given back
+    while(!pending_work.empty() && workers.size()<fork_workers)
+    {
+      path_replayt path=pending_work.front();
+      pending_work.pop_front();
+      number_of_forks++;
+
+      if(spawn_fork_worker(workers, work_request_fd, result_fd))
+        run_fork_worker(config, &path);
+    }
+
+    // spare capacity? ask the busy workers to give away states
+    if(!stop_search &&
+       pending_work.empty() &&
+       workers.size()<fork_workers)
+    {
+      const auto now=std::chrono::steady_clock::now();
+
+      for(auto &w : workers)
+        if(!w.request_pending &&
+           now>=w.last_refusal+std::chrono::milliseconds(100))
+        {
+          if(!write_all(w.request_fd, "R"))
+            w.request_pending=true;
+        }
+    }
+
+    // wait for reports
+    std::vector<pollfd> fds;
+    fds.reserve(workers.size());
+
+    for(const auto &w : workers)
+    {
+      pollfd pfd;
+      pfd.fd=w.result_fd;
+      pfd.events=POLLIN;
+      pfd.revents=0;
+      fds.push_back(pfd);
+    }
+
+    if(poll(fds.data(), fds.size(), 100)<0 && errno!=EINTR)
+      throw "poll failed";
+
+    auto fd_it=fds.begin();
+
+    for(auto w_it=workers.begin(); w_it!=workers.end(); fd_it++)
+    {
+      fork_workert &w=*w_it;
+
+      if(fd_it->revents==0)
+      {
+        ++w_it;
+        continue;
+      }
+
+      char buffer[4096];
+      ssize_t result=read(w.result_fd, buffer, sizeof(buffer));
+
+      if(result<0 && errno==EINTR)
+      {
+        ++w_it;
+        continue;
+      }
+
+      if(result>0)
+      {
+        w.buffer.append(buffer, result);
+
+        std::size_t pos;
+        while((pos=w.buffer.find('\n'))!=std::string::npos)
+        {
+          process_line(w, w.buffer.substr(0, pos));
+          w.buffer.erase(0, pos+1);
+        }
+
+        ++w_it;
+        continue;
+      }
+
+      // end of file, the worker is done
+      close(w.result_fd);
+      close(w.request_fd);
+
+      int wstatus;
+      waitpid(w.pid, &wstatus, 0);
+
+      if(!killed &&
+         (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus)!=0))
+      {
+        warning() << "worker process " << w.pid
+                  << " terminated abnormally" << eom;
+        number_of_dropped_states++;
+      }
+
+      w_it=workers.erase(w_it);
+    }
+  }
+
+  statistics() << "Number of worker processes: "
+               << number_of_forks << eom;
+}
+
+#endif
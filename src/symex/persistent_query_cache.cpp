@@ -0,0 +1,425 @@
+/*******************************************************************\
+
+Module: Cache of Solver Queries on Disk
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Cache of Solver Queries on Disk
+///
+/// The file starts with a header, followed by the records:
+///
+///   offset  header
+///        0  magic "symexqc", zero-terminated
+///        8  format version
+///       12  0x01020304, in the byte order of the writer
+///       16  sizeof(std::size_t) of the writer, as the hashes differ
+///       20  reserved
+///
+///   offset  record
+///        0  size of the record, a multiple of 8
+///        4  checksum of the rest of the record
+///        8  canonical hash
+///       16  number of constraints
+///       20  number of symbols
+///       24  1 if satisfiable, 0 if not
+///       28  solver time, as float
+///       32  number of values
+///       36  reserved
+///       40  canonical digest, the second hash of the query
+///       48  the values, each as length and characters; the length
+///           no_value stands for a value that is not known
+///
+/// A record that is cut short, e.g., as a process was killed while
+/// writing it, fails the checksum, and is truncated away by the next
+/// process that opens the file.
+
+#include "persistent_query_cache.h"
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+
+const char *persistent_query_cachet::file_name="queries.bin";
+const std::size_t persistent_query_cachet::appended;
+
+namespace
+{
+const char magic[8]="symexqc";
+const std::uint32_t format_version=2;
+const std::uint32_t byte_order=0x01020304;
+const std::size_t header_size=24;
+const std::size_t record_header_size=48;
+const std::uint32_t no_value=~std::uint32_t(0);
+
+template<typename T>
+T read_at(const char *p, std::size_t offset)
+{
+  T value;
+  std::memcpy(&value, p+offset, sizeof(T));
+  return value;
+}
+
+template<typename T>
+void write_at(std::string &dest, std::size_t offset, T value)
+{
+  std::memcpy(&dest[offset], &value, sizeof(T));
+}
+
+template<typename T>
+void append(std::string &dest, T value)
+{
+  dest.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/// FNV-1a
+std::uint32_t checksum(const char *p, std::size_t size)
+{
+  std::uint32_t h=2166136261u;
+
+  for(std::size_t i=0; i<size; i++)
+  {
+    h^=static_cast<unsigned char>(p[i]);
+    h*=16777619u;
+  }
+
+  return h;
+}
+}
+
+#ifdef _WIN32
+
+persistent_query_cachet::persistent_query_cachet():
+  fd(-1), mapping(nullptr), mapping_size(0)
+{
+}
+
+persistent_query_cachet::~persistent_query_cachet()
+{
+}
+
+void persistent_query_cachet::open(const std::string &)
+{
+  throw "--query-cache is not supported on this platform";
+}
+
+optionalt<persistent_query_cachet::resultt> persistent_query_cachet::lookup(
+  std::uint64_t,
+  std::uint64_t,
+  std::uint32_t,
+  std::uint32_t) const
+{
+  return {};
+}
+
+bool persistent_query_cachet::insert(
+  std::uint64_t,
+  std::uint64_t,
+  std::uint32_t,
+  std::uint32_t,
+  const resultt &)
+{
+  return true;
+}
+
+std::size_t persistent_query_cachet::read_index()
+{
+  return 0;
+}
+
+void persistent_query_cachet::close()
+{
+}
+
+#else
+
+/// Takes or releases a lock on the whole file. The locks are held by
+/// processes, and thus are not shared with fork workers.
+/// \return true on error
+static bool lock_file(int fd, short type)
+{
+  struct flock lock;
+  std::memset(&lock, 0, sizeof(lock));
+  lock.l_type=type;
+  lock.l_whence=SEEK_SET;
+  lock.l_start=0;
+  lock.l_len=0;
+
+  while(fcntl(fd, F_SETLKW, &lock)==-1)
+    if(errno!=EINTR)
+      return true;
+
+  return false;
+}
+
+/// writes all of 'data' to 'fd', returns true on error
+static bool write_all(int fd, const std::string &data)
+{
+  const char *p=data.data();
+  std::size_t left=data.size();
+
+  while(left!=0)
+  {
+    ssize_t result=write(fd, p, left);
+
+    if(result<0)
+    {
+      if(errno==EINTR)
+        continue;
+      return true;
+    }
+
+    p+=result;
+    left-=result;
+  }
+
+  return false;
+}
+
+persistent_query_cachet::persistent_query_cachet():
+  fd(-1), mapping(nullptr), mapping_size(0)
+{
+}
+
+persistent_query_cachet::~persistent_query_cachet()
+{
+  close();
+}
+
+void persistent_query_cachet::close()
+{
+  if(mapping!=nullptr)
+  {
+    munmap(const_cast<char *>(mapping), mapping_size);
+    mapping=nullptr;
+    mapping_size=0;
+  }
+
+  if(fd!=-1)
+  {
+    ::close(fd);
+    fd=-1;
+  }
+
+  index.clear();
+}
+
+void persistent_query_cachet::open(const std::string &directory)
+{
+  close();
+
+  if(mkdir(directory.c_str(), 0777)!=0 && errno!=EEXIST)
+    throw "failed to create query cache directory `"+directory+"'";
+
+  const std::string path=directory+"/"+file_name;
+
+  fd=::open(path.c_str(), O_RDWR|O_CREAT|O_APPEND|O_CLOEXEC, 0666);
+
+  if(fd==-1)
+    throw "failed to open query cache `"+path+"'";
+
+  if(lock_file(fd, F_WRLCK))
+  {
+    close();
+    throw "failed to lock query cache `"+path+"'";
+  }
+
+  struct stat buf;
+
+  if(fstat(fd, &buf)!=0)
+  {
+    close();
+    throw "failed to open query cache `"+path+"'";
+  }
+
+  std::size_t size=buf.st_size;
+
+  if(size==0)
+  {
+    std::string header(header_size, '\0');
+    std::memcpy(&header[0], magic, sizeof(magic));
+    write_at(header, 8, format_version);
+    write_at(header, 12, byte_order);
+    write_at(header, 16, std::uint32_t(sizeof(std::size_t)));
+
+    if(write_all(fd, header))
+    {
+      close();
+      throw "failed to write query cache `"+path+"'";
+    }
+
+    size=header_size;
+  }
+
+  void *p=mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  if(p==MAP_FAILED)
+  {
+    close();
+    throw "failed to map query cache `"+path+"'";
+  }
+
+  mapping=static_cast<const char *>(p);
+  mapping_size=size;
+
+  if(size<header_size ||
+     std::memcmp(mapping, magic, sizeof(magic))!=0 ||
+     read_at<std::uint32_t>(mapping, 8)!=format_version ||
+     read_at<std::uint32_t>(mapping, 12)!=byte_order ||
+     read_at<std::uint32_t>(mapping, 16)!=sizeof(std::size_t))
+  {
+    close();
+    throw "query cache `"+path+"' has an unknown format";
+  }
+
+  const std::size_t end=read_index();
+
+  // a record that was cut short would hide the ones appended later on
+  if(end<size && ftruncate(fd, end)!=0)
+  {
+    close();
+    throw "failed to repair query cache `"+path+"'";
+  }
+
+  lock_file(fd, F_UNLCK);
+}
+
+std::size_t persistent_query_cachet::read_index()
+{
+  std::size_t offset=header_size;
+
+  while(offset+record_header_size<=mapping_size)
+  {
+    const std::uint32_t size=read_at<std::uint32_t>(mapping, offset);
+
+    if(size<record_header_size || size%8!=0 || size>mapping_size-offset ||
+       read_at<std::uint32_t>(mapping, offset+4)!=
+         checksum(mapping+offset+8, size-8))
+      break;
+
+    // the first record wins
+    index.emplace(read_at<std::uint64_t>(mapping, offset+8), offset);
+
+    offset+=size;
+  }
+
+  return offset;
+}
+
+optionalt<persistent_query_cachet::resultt> persistent_query_cachet::lookup(
+  std::uint64_t canonical_hash,
+  std::uint64_t canonical_digest,
+  std::uint32_t number_of_constraints,
+  std::uint32_t number_of_symbols) const
+{
+  const auto i_it=index.find(canonical_hash);
+
+  // the records written by this process are also kept in memory
+  if(i_it==index.end() || i_it->second==appended)
+    return {};
+
+  const char *record=mapping+i_it->second;
+
+  if(read_at<std::uint32_t>(record, 16)!=number_of_constraints ||
+     read_at<std::uint32_t>(record, 20)!=number_of_symbols ||
+     read_at<std::uint64_t>(record, 40)!=canonical_digest)
+    return {};
+
+  resultt result;
+  result.satisfiable=read_at<std::uint32_t>(record, 24)!=0;
+  result.solver_time=read_at<float>(record, 28);
+
+  const std::uint32_t number_of_values=read_at<std::uint32_t>(record, 32);
+  const std::size_t size=read_at<std::uint32_t>(record, 0);
+  std::size_t offset=record_header_size;
+
+  result.values.reserve(number_of_values);
+
+  for(std::uint32_t i=0; i<number_of_values; i++)
+  {
+    if(offset+4>size)
+      return {};
+
+    const std::uint32_t length=read_at<std::uint32_t>(record, offset);
+    offset+=4;
+
+    if(length==no_value)
+    {
+      result.values.push_back(std::string());
+      continue;
+    }
+
+    if(length>size-offset)
+      return {};
+
+    result.values.push_back(std::string(record+offset, length));
+    offset+=length;
+  }
+
+  return result;
+}
+
+bool persistent_query_cachet::insert(
+  std::uint64_t canonical_hash,
+  std::uint64_t canonical_digest,
+  std::uint32_t number_of_constraints,
+  std::uint32_t number_of_symbols,
+  const resultt &result)
+{
+  if(fd==-1)
+    return true;
+
+  if(!index.emplace(canonical_hash, appended).second)
+    return false;
+
+  std::string record;
+  append(record, std::uint32_t(0));
+  append(record, std::uint32_t(0));
+  append(record, canonical_hash);
+  append(record, number_of_constraints);
+  append(record, number_of_symbols);
+  append(record, std::uint32_t(result.satisfiable?1:0));
+  append(record, result.solver_time);
+  append(record, std::uint32_t(result.values.size()));
+  append(record, std::uint32_t(0));
+  append(record, canonical_digest);
+
+  for(const auto &v : result.values)
+  {
+    if(v.empty())
+      append(record, no_value);
+    else
+    {
+      append(record, std::uint32_t(v.size()));
+      record+=v;
+    }
+  }
+
+  record.resize((record.size()+7)/8*8, '\0');
+
+  write_at(record, 0, std::uint32_t(record.size()));
+  write_at(record, 4, checksum(record.data()+8, record.size()-8));
+
+  // one write per record, under the lock, as other processes append
+  // to the same file
+  if(lock_file(fd, F_WRLCK))
+    return true;
+
+  const bool error=write_all(fd, record);
+
+  lock_file(fd, F_UNLCK);
+
+  return error;
+}
+
+#endif
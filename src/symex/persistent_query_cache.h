@@ -0,0 +1,101 @@
+/*******************************************************************\
+
+Module: Cache of Solver Queries on Disk
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Cache of Solver Queries on Disk
+
+#ifndef CPROVER_SYMEX_PERSISTENT_QUERY_CACHE_H
+#define CPROVER_SYMEX_PERSISTENT_QUERY_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <util/optional.h>
+
+/// The results of queries, by canonical hash, in a file that is kept
+/// from one run to the next. The file is only ever appended to, and
+/// may be shared by several processes at a time: the records are
+/// written under a lock, in one piece each. The records that are in
+/// the file when it is opened are memory-mapped, and are looked up
+/// in place; those written by other processes later on are seen by
+/// the next run.
+///
+/// A record holds the result of a query and the time the solver
+/// took, together with a second hash of the query, which is checked
+/// on lookup. For satisfiable queries, it holds the values of the
+/// symbols of the query, in canonical order, where these are
+/// constants.
+class persistent_query_cachet
+{
+public:
+  persistent_query_cachet();
+  ~persistent_query_cachet();
+
+  persistent_query_cachet(const persistent_query_cachet &)=delete;
+  persistent_query_cachet &operator=(const persistent_query_cachet &)=delete;
+
+  // Opens, or creates, the cache in the given directory, and
+  // throws a string on error.
+  void open(const std::string &directory);
+
+  struct resultt
+  {
+    bool satisfiable;
+    float solver_time;
+
+    // the constant values of the symbols, empty if not known
+    std::vector<std::string> values;
+  };
+
+  // The second, independent hash of the canonical form of the query,
+  // and the number of its constraints and symbols, guard against
+  // collisions of the canonical hashes.
+  optionalt<resultt> lookup(
+    std::uint64_t canonical_hash,
+    std::uint64_t canonical_digest,
+    std::uint32_t number_of_constraints,
+    std::uint32_t number_of_symbols) const;
+
+  // Appends the result to the file, unless there is one already.
+  // Returns true on error.
+  bool insert(
+    std::uint64_t canonical_hash,
+    std::uint64_t canonical_digest,
+    std::uint32_t number_of_constraints,
+    std::uint32_t number_of_symbols,
+    const resultt &);
+
+  std::size_t size() const
+  {
+    return index.size();
+  }
+
+  // the file name in the directory
+  static const char *file_name;
+
+protected:
+  int fd;
+
+  // the records that were in the file when it was opened
+  const char *mapping;
+  std::size_t mapping_size;
+
+  // The offsets of the records by canonical hash, or 'appended' for
+  // the records written by this process.
+  std::unordered_map<std::uint64_t, std::size_t> index;
+  static const std::size_t appended=~std::size_t(0);
+
+  // returns the end of the valid records
+  std::size_t read_index();
+
+  void close();
+};
+
+#endif // CPROVER_SYMEX_PERSISTENT_QUERY_CACHE_H
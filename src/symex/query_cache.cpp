@@ -0,0 +1,506 @@
+/*******************************************************************\
+
+Module: Cache of Solver Queries
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Cache of Solver Queries
+
+#include "query_cache.h"
+
+#include <algorithm>
+
+#include <util/irep_hash.h>
+#include <util/prefix.h>
+#include <util/simplify_expr.h>
+#include <util/string_hash.h>
+
+const std::size_t query_cachet::max_hashes;
+const std::size_t query_cachet::max_candidates;
+const std::size_t query_cachet::max_recent_models;
+
+path_queryt::path_queryt(
+  const std::vector<exprt> &_constraints,
+  const exprt &_goal):
+  constraints(_constraints),
+  goal(_goal)
+{
+  std::size_t h=0;
+
+  for(const auto &c : constraints)
+  {
+    elements.emplace_back(c.hash(), c);
+    h=hash_combine(h, hash_canonical(c));
+  }
+
+  if(goal.is_not_nil())
+  {
+    key=goal.hash();
+    elements.emplace_back(key, goal);
+    h=hash_combine(hash_combine(h, constraints.size()), hash_canonical(goal));
+  }
+  else
+    key=constraints.empty()?0:constraints.back().hash();
+
+  canonical_hash=h;
+
+  // sorted by hash, and then in the order of the ireps
+  std::sort(elements.begin(), elements.end());
+  elements.erase(
+    std::unique(elements.begin(), elements.end()), elements.end());
+
+  for(const auto &e : elements)
+    if(hashes.empty() || hashes.back()!=e.first)
+      hashes.push_back(e.first);
+}
+
+bool path_queryt::contains(std::size_t hash) const
+{
+  return std::binary_search(hashes.begin(), hashes.end(), hash);
+}
+
+/// \return true if all elements of 'subset' are in 'superset'
+static bool includes(
+  const path_queryt::elementst &superset,
+  const path_queryt::elementst &subset)
+{
+  return std::includes(
+    superset.begin(), superset.end(), subset.begin(), subset.end());
+}
+
+/// the SSA instances of the variables, and the fresh symbols
+/// for nondeterministic values
+static bool is_renamed(const irep_idt &identifier)
+{
+  const std::string &s=id2string(identifier);
+  return s.find('#')!=std::string::npos || has_prefix(s, "symex::nondet");
+}
+
+/// a hash of the string, which does not depend on the string table
+static std::size_t hash_id(const irep_idt &id)
+{
+  return hash_string(id2string(id));
+}
+
+/// A hash of the irep that is the same in other runs. The named
+/// sub-trees are ordered by the numbers of their names, which may
+/// differ, and are thus combined in a way that ignores their order.
+static std::size_t stable_hash(const irept &irep)
+{
+  std::size_t h=hash_id(irep.id());
+
+  for(const auto &sub : irep.get_sub())
+    h=hash_combine(h, stable_hash(sub));
+
+  std::size_t named=0;
+
+  for(const auto &n : irep.get_named_sub())
+    if(!irept::is_comment(n.first))
+      named+=hash_combine(hash_id(n.first), stable_hash(n.second));
+
+  return hash_combine(h, named);
+}
+
+/// the types are shared by many expressions, and are hashed once
+std::size_t path_queryt::hash_type(const typet &type)
+{
+  const auto entry=type_hashes.emplace(type, 0);
+
+  if(entry.second)
+    entry.first->second=stable_hash(type);
+
+  return entry.first->second;
+}
+
+std::size_t path_queryt::hash_canonical(const exprt &expr)
+{
+  if(expr.id()==ID_symbol && is_renamed(to_symbol_expr(expr).get_identifier()))
+  {
+    const auto entry=canonical_names.emplace(
+      to_symbol_expr(expr).get_identifier(), canonical_names.size());
+
+    if(entry.second)
+      symbols.push_back(to_symbol_expr(expr));
+
+    return hash_combine(
+      hash_combine(hash_id(ID_symbol), entry.first->second),
+      hash_type(expr.type()));
+  }
+
+  std::size_t h=hash_combine(hash_id(expr.id()), hash_type(expr.type()));
+
+  for(const auto &op : expr.operands())
+    h=hash_combine(h, hash_canonical(op));
+
+  // the other named sub-trees do not refer to SSA symbols
+  std::size_t named=0;
+
+  for(const auto &n : expr.get_named_sub())
+    if(n.first!=ID_type && !irept::is_comment(n.first))
+      named+=hash_combine(hash_id(n.first), stable_hash(n.second));
+
+  return hash_combine(h, named);
+}
+
+/// FNV-1a, 64 bits
+static void digest_bytes(std::uint64_t &h, const char *p, std::size_t size)
+{
+  for(std::size_t i=0; i<size; i++)
+  {
+    h^=static_cast<unsigned char>(p[i]);
+    h*=1099511628211ull;
+  }
+}
+
+/// in little-endian order, which is the same on all hosts
+static void digest_number(std::uint64_t &h, std::uint64_t n)
+{
+  char bytes[8];
+
+  for(unsigned i=0; i<8; i++)
+    bytes[i]=static_cast<char>((n>>(8*i))&0xff);
+
+  digest_bytes(h, bytes, sizeof(bytes));
+}
+
+static void digest_string(std::uint64_t &h, const std::string &s)
+{
+  digest_number(h, s.size());
+  digest_bytes(h, s.data(), s.size());
+}
+
+/// Adds the irep to the digest, with the renamed symbols replaced by
+/// their numbers. The named sub-trees go in the order of their names.
+void path_queryt::digest(const irept &irep, std::uint64_t &h) const
+{
+  if(irep.id()==ID_symbol)
+  {
+    const auto n_it=canonical_names.find(irep.get(ID_identifier));
+
+    if(n_it!=canonical_names.end())
+    {
+      digest_string(h, "#");
+      digest_number(h, n_it->second);
+      digest(irep.find(ID_type), h);
+      return;
+    }
+  }
+
+  digest_string(h, id2string(irep.id()));
+
+  digest_number(h, irep.get_sub().size());
+  for(const auto &sub : irep.get_sub())
+    digest(sub, h);
+
+  std::vector<std::pair<std::string, const irept *>> named;
+
+  for(const auto &n : irep.get_named_sub())
+    if(!irept::is_comment(n.first))
+      named.emplace_back(id2string(n.first), &n.second);
+
+  std::sort(named.begin(), named.end());
+
+  digest_number(h, named.size());
+  for(const auto &n : named)
+  {
+    digest_string(h, n.first);
+    digest(*n.second, h);
+  }
+}
+
+std::uint64_t path_queryt::canonical_digest() const
+{
+  std::uint64_t h=14695981039346656037ull;
+
+  digest_number(h, constraints.size());
+  for(const auto &c : constraints)
+    digest(c, h);
+
+  digest(goal, h);
+
+  return h;
+}
+
+optionalt<bool> query_cachet::lookup(
+  const path_queryt &query,
+  const namespacet &ns)
+{
+  number_of_queries++;
+
+  // the same query, up to the names of the SSA symbols
+  const auto c_it=canonical_entries.find(query.canonical_hash);
+
+  if(c_it!=canonical_entries.end() &&
+     is_renaming(entries[c_it->second], query))
+  {
+    const entryt &entry=entries[c_it->second];
+    hit(entry, number_of_exact_hits);
+    return entry.satisfiable;
+  }
+
+  // the same query, solved in an earlier run
+  if(persistent!=nullptr)
+  {
+    const auto result=persistent->lookup(
+      query.canonical_hash,
+      query.canonical_digest(),
+      query.constraints.size(),
+      query.symbols.size());
+
+    if(result.has_value())
+    {
+      number_of_persistent_hits++;
+      saved_time+=result->solver_time;
+
+      std::vector<exprt> model;
+
+      for(std::size_t i=0; i<result->values.size(); i++)
+        if(i<query.symbols.size() && !result->values[i].empty())
+          model.push_back(
+            constant_exprt(result->values[i], query.symbols[i].type()));
+        else
+          model.push_back(nil_exprt());
+
+      add(query, result->satisfiable, std::move(model), result->solver_time);
+      return result->satisfiable;
+    }
+  }
+
+  // an unsatisfiable subset
+  for(const auto h : query.hashes)
+  {
+    const auto u_it=unsat_entries.find(h);
+
+    if(u_it==unsat_entries.end())
+      continue;
+
+    std::size_t count=0;
+
+    for(auto e_it=u_it->second.rbegin();
+        e_it!=u_it->second.rend() && count<max_candidates;
+        e_it++, count++)
+    {
+      const entryt &entry=entries[*e_it];
+
+      if(includes(query.elements, entry.elements))
+      {
+        hit(entry, number_of_subset_hits);
+        return false;
+      }
+    }
+  }
+
+  // a satisfiable superset
+  const auto s_it=sat_entries.find(query.key);
+
+  if(s_it!=sat_entries.end())
+  {
+    std::size_t count=0;
+
+    for(auto e_it=s_it->second.rbegin();
+        e_it!=s_it->second.rend() && count<max_candidates;
+        e_it++, count++)
+    {
+      const entryt &entry=entries[*e_it];
+
+      if(includes(entry.elements, query.elements))
+      {
+        hit(entry, number_of_superset_hits);
+        return true;
+      }
+    }
+  }
+
+  // a recent model
+  for(auto m_it=recent_models.begin(); m_it!=recent_models.end(); m_it++)
+  {
+    if(is_model(*m_it, query, ns))
+    {
+      number_of_model_hits++;
+
+      // keep it in front
+      std::rotate(recent_models.begin(), m_it, std::next(m_it));
+      return true;
+    }
+  }
+
+  return {};
+}
+
+/// Confirms a match of the canonical hashes: the query of the entry
+/// is the given one once its SSA symbols are renamed to those of the
+/// given query, in the order in which they occur.
+bool query_cachet::is_renaming(const entryt &entry, const path_queryt &query)
+{
+  if(entry.constraints.size()!=query.constraints.size() ||
+     entry.symbols.size()!=query.symbols.size() ||
+     entry.goal.is_nil()!=query.goal.is_nil())
+    return false;
+
+  replace_symbolt renaming;
+
+  for(std::size_t i=0; i<entry.symbols.size(); i++)
+  {
+    if(entry.symbols[i].type()!=query.symbols[i].type())
+      return false;
+
+    renaming.insert(entry.symbols[i], query.symbols[i]);
+  }
+
+  for(std::size_t i=0; i<entry.constraints.size(); i++)
+  {
+    exprt tmp=entry.constraints[i];
+    renaming.replace(tmp);
+
+    if(tmp!=query.constraints[i])
+      return false;
+  }
+
+  exprt tmp=entry.goal;
+  renaming.replace(tmp);
+
+  return tmp==query.goal;
+}
+
+/// Evaluates the constraints of the query, in path order, under the
+/// given values. A symbol without value that is defined by an equality
+/// gets the value of the right-hand side; as the SSA symbols are
+/// assigned once, this is the value it has on the path.
+/// \return true if all constraints and the goal simplify to true
+bool query_cachet::is_model(
+  replace_symbolt values,
+  const path_queryt &query,
+  const namespacet &ns) const
+{
+  for(const auto &c : query.constraints)
+  {
+    if(c.id()==ID_equal &&
+       to_equal_expr(c).lhs().id()==ID_symbol &&
+       !values.replaces_symbol(
+         to_symbol_expr(to_equal_expr(c).lhs()).get_identifier()))
+    {
+      exprt value=to_equal_expr(c).rhs();
+      values.replace(value);
+      simplify(value, ns);
+      values.insert(to_symbol_expr(to_equal_expr(c).lhs()), value);
+      continue;
+    }
+
+    exprt tmp=c;
+    values.replace(tmp);
+
+    if(!simplify_expr(tmp, ns).is_true())
+      return false;
+  }
+
+  if(query.goal.is_nil())
+    return true;
+
+  exprt tmp=query.goal;
+  values.replace(tmp);
+
+  return simplify_expr(tmp, ns).is_true();
+}
+
+void query_cachet::insert(
+  const path_queryt &query,
+  bool satisfiable,
+  std::vector<exprt> model,
+  double solver_time)
+{
+  if(persistent!=nullptr)
+  {
+    persistent_query_cachet::resultt result;
+    result.satisfiable=satisfiable;
+    result.solver_time=solver_time;
+
+    // only constants are kept, which are read back with the type of
+    // the symbol
+    for(std::size_t i=0; i<model.size() && i<query.symbols.size(); i++)
+    {
+      const exprt &value=model[i];
+
+      if(value.id()==ID_constant &&
+         !value.has_operands() &&
+         value.type()==query.symbols[i].type())
+        result.values.push_back(
+          id2string(to_constant_expr(value).get_value()));
+      else
+        result.values.push_back(std::string());
+    }
+
+    if(persistent->insert(
+         query.canonical_hash,
+         query.canonical_digest(),
+         query.constraints.size(),
+         query.symbols.size(),
+         result))
+      number_of_persistent_errors++;
+  }
+
+  add(query, satisfiable, std::move(model), solver_time);
+}
+
+void query_cachet::add(
+  const path_queryt &query,
+  bool satisfiable,
+  std::vector<exprt> model,
+  double solver_time)
+{
+  if(number_of_hashes+query.hashes.size()>max_hashes)
+    clear();
+
+  const std::size_t nr=entries.size();
+  entries.push_back(entryt());
+
+  entryt &entry=entries.back();
+  entry.satisfiable=satisfiable;
+  entry.constraints=query.constraints;
+  entry.goal=query.goal;
+  entry.symbols=query.symbols;
+  entry.elements=query.elements;
+  entry.model=std::move(model);
+  entry.solver_time=solver_time;
+
+  number_of_hashes+=query.hashes.size();
+  canonical_entries[query.canonical_hash]=nr;
+
+  if(satisfiable)
+  {
+    for(const auto h : query.hashes)
+      sat_entries[h].push_back(nr);
+
+    replace_symbolt values;
+
+    for(std::size_t i=0; i<query.symbols.size() && i<entry.model.size(); i++)
+      if(entry.model[i].is_not_nil())
+        values.insert(query.symbols[i], entry.model[i]);
+
+    recent_models.push_front(std::move(values));
+
+    if(recent_models.size()>max_recent_models)
+      recent_models.pop_back();
+  }
+  else
+    unsat_entries[query.key].push_back(nr);
+}
+
+void query_cachet::open_persistent(const std::string &directory)
+{
+  std::unique_ptr<persistent_query_cachet> p(new persistent_query_cachet());
+  p->open(directory);
+  persistent=std::move(p);
+}
+
+void query_cachet::clear()
+{
+  entries.clear();
+  number_of_hashes=0;
+  canonical_entries.clear();
+  unsat_entries.clear();
+  sat_entries.clear();
+  recent_models.clear();
+}
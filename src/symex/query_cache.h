@@ -0,0 +1,214 @@
+/*******************************************************************\
+
+Module: Cache of Solver Queries
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Cache of Solver Queries
+
+#ifndef CPROVER_SYMEX_QUERY_CACHE_H
+#define CPROVER_SYMEX_QUERY_CACHE_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <util/namespace.h>
+#include <util/optional.h>
+#include <util/replace_symbol.h>
+#include <util/std_expr.h>
+
+#include "persistent_query_cache.h"
+
+/// A query to the decision procedure: constraints of a path, in the
+/// order of the path, and possibly a goal.
+class path_queryt
+{
+public:
+  path_queryt(const std::vector<exprt> &_constraints, const exprt &_goal);
+
+  std::vector<exprt> constraints;
+  exprt goal;
+
+  // the hashes of the constraints and the goal, sorted, and
+  // without duplicates
+  std::vector<std::size_t> hashes;
+
+  // the constraints and the goal with their hashes, sorted by hash,
+  // and without duplicates, to confirm the matches of the hashes
+  typedef std::vector<std::pair<std::size_t, exprt>> elementst;
+  elementst elements;
+
+  // the hash of the goal, or else of the last constraint
+  std::size_t key;
+
+  // A hash of the query with the SSA symbols renamed in the order in
+  // which they occur. Queries that differ only in the instances of
+  // the variables, e.g., in two iterations of a loop, have the same
+  // canonical hash. It is computed from the strings of the ireps,
+  // and not their numbers, and thus is the same in other runs.
+  std::size_t canonical_hash;
+
+  // the renamed symbols, in that order
+  std::vector<symbol_exprt> symbols;
+
+  bool contains(std::size_t hash) const;
+
+  // A second hash of the canonical form, computed independently of
+  // canonical_hash, which confirms the results kept on disk.
+  std::uint64_t canonical_digest() const;
+
+protected:
+  std::unordered_map<irep_idt, std::size_t, irep_id_hash> canonical_names;
+  std::unordered_map<typet, std::size_t, irep_hash> type_hashes;
+  std::size_t hash_canonical(const exprt &);
+  std::size_t hash_type(const typet &);
+  void digest(const irept &, std::uint64_t &) const;
+};
+
+/// Caches the results of queries, in the style of KLEE's
+/// counterexample cache. A query is answered if
+///  - a query with the same canonical hash has been solved,
+///  - an unsatisfiable query has been solved whose constraints are a
+///    subset of those of the query, or
+///  - a satisfiable query has been solved whose constraints are a
+///    superset of those of the query, or
+///  - one of the most recent satisfying assignments satisfies the
+///    query when its constraints are evaluated.
+/// The matches of the hashes are confirmed by comparing the
+/// expressions, which the entries keep. The values of the symbols in
+/// the satisfying assignments are kept, in canonical order.
+/// Optionally, the results are also kept on disk, by canonical hash,
+/// for later runs.
+class query_cachet
+{
+public:
+  query_cachet():
+    number_of_queries(0),
+    number_of_exact_hits(0),
+    number_of_subset_hits(0),
+    number_of_superset_hits(0),
+    number_of_model_hits(0),
+    number_of_persistent_hits(0),
+    number_of_persistent_errors(0),
+    saved_time(0),
+    number_of_hashes(0)
+  {
+  }
+
+  // true if satisfiable, false if not, nothing if not known
+  optionalt<bool> lookup(const path_queryt &, const namespacet &);
+
+  // The model holds the values of the symbols of the query, in
+  // canonical order, if satisfiable.
+  void insert(
+    const path_queryt &,
+    bool satisfiable,
+    std::vector<exprt> model,
+    double solver_time);
+
+  // Keeps the results in the given directory, too. Throws a string
+  // on error.
+  void open_persistent(const std::string &directory);
+
+  bool has_persistent() const
+  {
+    return persistent!=nullptr;
+  }
+
+  // the number of results on disk
+  std::size_t persistent_size() const
+  {
+    return persistent==nullptr?0:persistent->size();
+  }
+
+  // empties the cache in memory
+  void clear();
+
+  // statistics
+  std::size_t number_of_queries;
+  std::size_t number_of_exact_hits;
+  std::size_t number_of_subset_hits;
+  std::size_t number_of_superset_hits;
+  std::size_t number_of_model_hits;
+  std::size_t number_of_persistent_hits;
+  std::size_t number_of_persistent_errors;
+
+  // the solver time of the queries that answered the hits
+  double saved_time;
+
+  std::size_t number_of_hits() const
+  {
+    return number_of_exact_hits+number_of_subset_hits+
+           number_of_superset_hits+number_of_model_hits+
+           number_of_persistent_hits;
+  }
+
+  // the cache is emptied when it holds more constraints than this
+  static const std::size_t max_hashes=1<<22;
+
+protected:
+  struct entryt
+  {
+    bool satisfiable;
+
+    // the query, which is shared with the path it came from
+    std::vector<exprt> constraints;
+    exprt goal;
+    std::vector<symbol_exprt> symbols;
+    path_queryt::elementst elements;
+
+    std::vector<exprt> model;
+    double solver_time;
+  };
+
+  static bool is_renaming(const entryt &, const path_queryt &);
+
+  std::vector<entryt> entries;
+  std::size_t number_of_hashes;
+
+  // the entries by canonical hash
+  std::unordered_map<std::size_t, std::size_t> canonical_entries;
+
+  // the unsatisfiable entries, by their key
+  std::unordered_map<std::size_t, std::vector<std::size_t>> unsat_entries;
+
+  // the satisfiable entries, by each of their constraints
+  std::unordered_map<std::size_t, std::vector<std::size_t>> sat_entries;
+
+  // how many candidates are compared at most
+  static const std::size_t max_candidates=16;
+
+  // The most recent satisfying assignments, most recent first. As the
+  // queries come from neighbouring paths, these often satisfy the next
+  // query, too.
+  std::deque<replace_symbolt> recent_models;
+  static const std::size_t max_recent_models=4;
+
+  std::unique_ptr<persistent_query_cachet> persistent;
+
+  // adds the entry to the cache in memory
+  void add(
+    const path_queryt &,
+    bool satisfiable,
+    std::vector<exprt> model,
+    double solver_time);
+
+  bool is_model(
+    replace_symbolt values,
+    const path_queryt &,
+    const namespacet &) const;
+
+  void hit(const entryt &entry, std::size_t &counter)
+  {
+    counter++;
+    saved_time+=entry.solver_time;
+  }
+};
+
+#endif // CPROVER_SYMEX_QUERY_CACHE_H
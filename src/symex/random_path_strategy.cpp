@@ -0,0 +1,160 @@
+/*******************************************************************\
+
+Module: Random-Path Search Strategy
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Random-Path Search Strategy
+
+#include "random_path_strategy.h"
+
+#include <algorithm>
+
+const std::size_t random_path_strategyt::no_node;
+const std::size_t random_path_strategyt::root;
+
+random_path_strategyt::random_path_strategyt(unsigned seed):
+  generator(seed)
+{
+  clear_index();
+}
+
+void random_path_strategyt::clear_index()
+{
+  nodes.clear();
+  free_nodes.clear();
+  leaves.clear();
+  in_flight=no_node;
+
+  // the root is an inner node, and is never removed
+  new_node(no_node);
+}
+
+std::size_t random_path_strategyt::new_node(std::size_t parent)
+{
+  std::size_t node;
+
+  if(free_nodes.empty())
+  {
+    node=nodes.size();
+    nodes.push_back(nodet());
+  }
+  else
+  {
+    node=free_nodes.back();
+    free_nodes.pop_back();
+  }
+
+  nodet &n=nodes[node];
+  n.parent=parent;
+  n.children.clear();
+  n.is_leaf=false;
+
+  if(parent!=no_node)
+    nodes[parent].children.push_back(node);
+
+  return node;
+}
+
+void random_path_strategyt::add(
+  queuet::iterator state,
+  std::size_t sequence_number)
+{
+  // States pushed without a state being popped before,
+  // e.g., the initial state, hang off the root.
+  const std::size_t parent=in_flight==no_node?root:in_flight;
+
+  const std::size_t leaf=new_node(parent);
+  nodes[leaf].is_leaf=true;
+  nodes[leaf].state=state;
+  leaves[sequence_number]=leaf;
+}
+
+void random_path_strategyt::end_push()
+{
+  if(in_flight==no_node)
+    return;
+
+  const std::size_t node=in_flight;
+  in_flight=no_node;
+
+  // the popped state has finished, or has a single successor
+  if(nodes[node].children.empty())
+    prune(node);
+  else if(nodes[node].children.size()==1)
+    compress(node);
+}
+
+random_path_strategyt::queuet::iterator random_path_strategyt::pick()
+{
+  // the successors of the previous state have not been pushed
+  end_push();
+
+  std::size_t node=root;
+
+  while(!nodes[node].is_leaf)
+  {
+    const std::vector<std::size_t> &children=nodes[node].children;
+    INVARIANT(!children.empty(), "inner nodes must have children");
+    node=children[generator()%children.size()];
+  }
+
+  const queuet::iterator result=nodes[node].state;
+  leaves.erase(sequence_numbers.at(&*result));
+
+  // the successors will become the children of the leaf
+  nodes[node].is_leaf=false;
+  in_flight=node;
+
+  return result;
+}
+
+void random_path_strategyt::remove(
+  queuet::iterator,
+  std::size_t sequence_number)
+{
+  const auto l_it=leaves.find(sequence_number);
+  PRECONDITION(l_it!=leaves.end());
+  const std::size_t leaf=l_it->second;
+  leaves.erase(l_it);
+  prune(leaf);
+}
+
+/// removes a node without children, and then the inner nodes that
+/// are left without any, or with just one child
+void random_path_strategyt::prune(std::size_t node)
+{
+  PRECONDITION(node!=root);
+
+  const std::size_t parent=nodes[node].parent;
+  std::vector<std::size_t> &siblings=nodes[parent].children;
+  siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+  free_nodes.push_back(node);
+
+  if(parent==root || parent==in_flight)
+    return;
+
+  if(siblings.empty())
+    prune(parent);
+  else if(siblings.size()==1)
+    compress(parent);
+}
+
+/// replaces an inner node with just one child by the child
+void random_path_strategyt::compress(std::size_t node)
+{
+  PRECONDITION(node!=root);
+  PRECONDITION(nodes[node].children.size()==1);
+
+  const std::size_t child=nodes[node].children.front();
+  const std::size_t parent=nodes[node].parent;
+
+  std::vector<std::size_t> &siblings=nodes[parent].children;
+  *std::find(siblings.begin(), siblings.end(), node)=child;
+  nodes[child].parent=parent;
+
+  free_nodes.push_back(node);
+}
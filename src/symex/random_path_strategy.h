@@ -0,0 +1,71 @@
+/*******************************************************************\
+
+Module: Random-Path Search Strategy
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Random-Path Search Strategy
+
+#ifndef CPROVER_SYMEX_RANDOM_PATH_STRATEGY_H
+#define CPROVER_SYMEX_RANDOM_PATH_STRATEGY_H
+
+#include <limits>
+
+#include "search_strategy.h"
+
+/// Random-path search in the style of KLEE. The strategy maintains
+/// the execution tree of the queued states, whose inner nodes are the
+/// points where a state has split up, and whose leaves are the queued
+/// states. A state is picked by walking from the root, choosing a
+/// child uniformly at random at every inner node. Thus, a state below
+/// d splits is picked with probability 2^-d, and states in shallow
+/// subtrees are not starved by large, deep ones. The walk only uses
+/// the given seed, and thus, the same seed gives the same search.
+class random_path_strategyt:public search_strategyt
+{
+public:
+  explicit random_path_strategyt(unsigned seed);
+
+  void end_push() override;
+
+protected:
+  std::mt19937 generator;
+
+  static const std::size_t no_node=std::numeric_limits<std::size_t>::max();
+
+  struct nodet
+  {
+    std::size_t parent;
+    std::vector<std::size_t> children;
+
+    // for the leaves
+    bool is_leaf;
+    queuet::iterator state;
+  };
+
+  std::vector<nodet> nodes;
+  std::vector<std::size_t> free_nodes;
+
+  // the leaves, by sequence number
+  std::unordered_map<std::size_t, std::size_t> leaves;
+
+  // the node of the state popped last, whose successors
+  // are pushed next
+  std::size_t in_flight;
+
+  static const std::size_t root=0;
+
+  void add(queuet::iterator, std::size_t sequence_number) override;
+  queuet::iterator pick() override;
+  void remove(queuet::iterator, std::size_t sequence_number) override;
+  void clear_index() override;
+
+  std::size_t new_node(std::size_t parent);
+  void prune(std::size_t node);
+  void compress(std::size_t node);
+};
+
+#endif // CPROVER_SYMEX_RANDOM_PATH_STRATEGY_H
@@ -0,0 +1,316 @@
+/*******************************************************************\
+
+Module: Search Strategies for Path-based Symbolic Execution
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Search Strategies for Path-based Symbolic Execution
+
+#include "search_strategy.h"
+
+#include "locs_heuristic.h"
+#include "random_path_strategy.h"
+
+std::unique_ptr<search_strategyt> new_search_strategy(
+  const std::string &name,
+  unsigned seed)
+{
+  if(name=="dfs")
+    return std::unique_ptr<search_strategyt>(new sequence_strategyt(true));
+  else if(name=="bfs")
+    return std::unique_ptr<search_strategyt>(new sequence_strategyt(false));
+  else if(name=="random-path")
+    return std::unique_ptr<search_strategyt>(new random_path_strategyt(seed));
+  else if(name=="depth")
+    return std::unique_ptr<search_strategyt>(
+      new depth_weighted_strategyt(seed));
+  else if(name=="icnt")
+    return std::unique_ptr<search_strategyt>(
+      new min_instruction_count_strategyt());
+  else if(name=="locs")
+    return std::unique_ptr<search_strategyt>(new locs_heuristict());
+  else if(name=="topological")
+    return std::unique_ptr<search_strategyt>(new topological_strategyt());
+  else
+    return nullptr;
+}
+
+void sequence_strategyt::add(
+  queuet::iterator state,
+  std::size_t sequence_number)
+{
+  // the sequence numbers are increasing
+  states.emplace_hint(states.end(), sequence_number, state);
+}
+
+sequence_strategyt::queuet::iterator sequence_strategyt::pick()
+{
+  const statest::iterator s_it=
+    newest_first?std::prev(states.end()):states.begin();
+  const queuet::iterator result=s_it->second;
+  states.erase(s_it);
+  return result;
+}
+
+void sequence_strategyt::remove(
+  queuet::iterator,
+  std::size_t sequence_number)
+{
+  states.erase(sequence_number);
+}
+
+void weighted_random_strategyt::add(
+  queuet::iterator state,
+  std::size_t sequence_number)
+{
+  const double w=weight(*state);
+  std::size_t slot;
+
+  if(free_slots.empty())
+  {
+    slot=slots.size();
+    slots.push_back(slott());
+
+    // The new node of the Fenwick tree covers the slots
+    // (i-lowbit(i), i], 1-based; all but the last are known.
+    const std::size_t i=slot+1;
+    tree.push_back(prefix_sum(i-1)-prefix_sum(i-lowbit(i)));
+  }
+  else
+  {
+    slot=free_slots.back();
+    free_slots.pop_back();
+  }
+
+  slots[slot].state=state;
+  slots[slot].weight=w;
+  slots[slot].used=true;
+  slots[slot].sequence_number=sequence_number;
+  add_weight(slot, w);
+  slot_map[sequence_number]=slot;
+}
+
+weighted_random_strategyt::queuet::iterator weighted_random_strategyt::pick()
+{
+  // 32 bits of randomness suffice, and std::mt19937 gives the same
+  // sequence on all platforms, unlike the std:: distributions
+  const double total=prefix_sum(slots.size());
+  const double r=(generator()/4294967296.0)*total;
+
+  std::size_t slot=find_slot(r);
+
+  if(slot>=slots.size() || !slots[slot].used)
+  {
+    // rounding errors have accumulated
+    rebuild();
+    slot=find_slot(r*prefix_sum(slots.size())/total);
+
+    // the last used slot, as a last resort
+    if(slot>=slots.size() || !slots[slot].used)
+    {
+      slot=slots.size();
+      do
+        slot--;
+      while(!slots[slot].used);
+    }
+  }
+
+  const queuet::iterator result=slots[slot].state;
+  slot_map.erase(slots[slot].sequence_number);
+  free_slot(slot);
+  return result;
+}
+
+void weighted_random_strategyt::remove(
+  queuet::iterator,
+  std::size_t sequence_number)
+{
+  const auto m_it=slot_map.find(sequence_number);
+  PRECONDITION(m_it!=slot_map.end());
+  const std::size_t slot=m_it->second;
+  slot_map.erase(m_it);
+  free_slot(slot);
+}
+
+void weighted_random_strategyt::clear_index()
+{
+  slots.clear();
+  free_slots.clear();
+  slot_map.clear();
+  tree.clear();
+  removals_since_rebuild=0;
+}
+
+void weighted_random_strategyt::free_slot(std::size_t slot)
+{
+  add_weight(slot, -slots[slot].weight);
+  slots[slot].weight=0;
+  slots[slot].used=false;
+  free_slots.push_back(slot);
+
+  // the subtractions make the partial sums drift
+  if(++removals_since_rebuild>=slots.size())
+    rebuild();
+}
+
+void weighted_random_strategyt::add_weight(std::size_t slot, double delta)
+{
+  for(std::size_t i=slot+1; i<=tree.size(); i+=lowbit(i))
+    tree[i-1]+=delta;
+}
+
+double weighted_random_strategyt::prefix_sum(std::size_t count) const
+{
+  double sum=0;
+  for(std::size_t i=count; i>0; i-=lowbit(i))
+    sum+=tree[i-1];
+  return sum;
+}
+
+/// \return the first slot at which the partial sum exceeds the given
+///   value
+std::size_t weighted_random_strategyt::find_slot(double value) const
+{
+  std::size_t step=1;
+  while(step*2<=tree.size())
+    step*=2;
+
+  std::size_t pos=0;
+
+  for(; step!=0; step/=2)
+    if(pos+step<=tree.size() && tree[pos+step-1]<=value)
+    {
+      pos+=step;
+      value-=tree[pos-1];
+    }
+
+  return pos;
+}
+
+void weighted_random_strategyt::rebuild()
+{
+  for(std::size_t slot=0; slot<slots.size(); slot++)
+    tree[slot]=slots[slot].weight;
+
+  for(std::size_t i=1; i<=tree.size(); i++)
+  {
+    const std::size_t parent=i+lowbit(i);
+    if(parent<=tree.size())
+      tree[parent-1]+=tree[i-1];
+  }
+
+  removals_since_rebuild=0;
+}
+
+double depth_weighted_strategyt::weight(const statet &state) const
+{
+  return 1.0/(state.get_depth()+1.0);
+}
+
+void location_strategyt::build(const goto_functionst &goto_functions)
+{
+  clear();
+  cfg_distance.build(goto_functions);
+}
+
+void location_strategyt::add(
+  queuet::iterator state,
+  std::size_t sequence_number)
+{
+  const std::size_t nr=cfg_distance[state->pc()];
+
+  const auto b_it=buckets.find(nr);
+
+  if(b_it==buckets.end())
+  {
+    buckett &bucket=buckets[nr];
+    bucket.score=score(nr);
+    bucket.states.emplace(sequence_number, state);
+    order.insert(std::make_pair(bucket.score, nr));
+  }
+  else
+    b_it->second.states.emplace_hint(
+      b_it->second.states.end(), sequence_number, state);
+}
+
+location_strategyt::queuet::iterator location_strategyt::pick()
+{
+  const ordert::iterator o_it=order.begin();
+  const bucketst::iterator b_it=buckets.find(o_it->second);
+  INVARIANT(b_it!=buckets.end(), "ordered location must have states");
+
+  // the most recent state first
+  const auto s_it=std::prev(b_it->second.states.end());
+  const queuet::iterator result=s_it->second;
+  b_it->second.states.erase(s_it);
+
+  if(b_it->second.states.empty())
+  {
+    buckets.erase(b_it);
+    order.erase(o_it);
+  }
+
+  return result;
+}
+
+void location_strategyt::remove(
+  queuet::iterator state,
+  std::size_t sequence_number)
+{
+  const std::size_t nr=cfg_distance[state->pc()];
+  const bucketst::iterator b_it=buckets.find(nr);
+  PRECONDITION(b_it!=buckets.end());
+
+  b_it->second.states.erase(sequence_number);
+
+  if(b_it->second.states.empty())
+  {
+    order.erase(std::make_pair(b_it->second.score, nr));
+    buckets.erase(b_it);
+  }
+}
+
+void location_strategyt::update_score(std::size_t nr)
+{
+  const bucketst::iterator b_it=buckets.find(nr);
+
+  if(b_it==buckets.end())
+    return;
+
+  const unsigned new_score=score(nr);
+
+  if(new_score==b_it->second.score)
+    return;
+
+  order.erase(std::make_pair(b_it->second.score, nr));
+  b_it->second.score=new_score;
+  order.insert(std::make_pair(new_score, nr));
+}
+
+void location_strategyt::update_scores()
+{
+  order.clear();
+
+  for(auto &b : buckets)
+  {
+    b.second.score=score(b.first);
+    order.insert(std::make_pair(b.second.score, b.first));
+  }
+}
+
+void min_instruction_count_strategyt::build(
+  const goto_functionst &goto_functions)
+{
+  location_strategyt::build(goto_functions);
+  counts.assign(cfg_distance.size(), 0);
+}
+
+void min_instruction_count_strategyt::visit(const loc_reft &l)
+{
+  const std::size_t nr=cfg_distance[l];
+  counts[nr]++;
+  update_score(nr);
+}
@@ -0,0 +1,448 @@
+/*******************************************************************\
+
+Module: Search Strategies for Path-based Symbolic Execution
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Search Strategies for Path-based Symbolic Execution
+
+#ifndef CPROVER_SYMEX_SEARCH_STRATEGY_H
+#define CPROVER_SYMEX_SEARCH_STRATEGY_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <path-symex/path_symex_state.h>
+
+#include "cfg_distance.h"
+
+/// Decides which of the queued states is explored next. The states
+/// are kept in a std::list owned by the caller, whose iterators are
+/// stable; a strategy merely indexes them. Every state is given a
+/// sequence number when it is pushed, which orders the states by age.
+class search_strategyt
+{
+public:
+  typedef path_symex_statet statet;
+  typedef std::list<statet> queuet;
+
+  search_strategyt():next_sequence_number(0)
+  {
+  }
+
+  virtual ~search_strategyt()
+  {
+  }
+
+  // called once before the search starts
+  virtual void build(const goto_functionst &)
+  {
+  }
+
+  // Called after a batch of states has been pushed. If a state has
+  // been popped since the previous batch, these are its successors.
+  virtual void end_push()
+  {
+  }
+
+  // Records that a location has been executed. This may change the
+  // scores of the queued states, which are then updated in the index.
+  virtual void visit(const loc_reft &)
+  {
+  }
+
+  void push(queuet::iterator state)
+  {
+    const std::size_t nr=next_sequence_number++;
+    sequence_numbers[&*state]=nr;
+    add(state, nr);
+  }
+
+  // removes the state to be explored next from the index
+  queuet::iterator pop()
+  {
+    PRECONDITION(!empty());
+    const queuet::iterator state=pick();
+    sequence_numbers.erase(&*state);
+    return state;
+  }
+
+  // removes the given state from the index
+  void erase(queuet::iterator state)
+  {
+    const auto s_it=sequence_numbers.find(&*state);
+    PRECONDITION(s_it!=sequence_numbers.end());
+    remove(state, s_it->second);
+    sequence_numbers.erase(s_it);
+  }
+
+  void clear()
+  {
+    sequence_numbers.clear();
+    clear_index();
+  }
+
+  // Whether the oldest states are explored first. Then the most
+  // recent states are the ones that are not needed for longest.
+  virtual bool picks_oldest() const
+  {
+    return false;
+  }
+
+  std::size_t size() const
+  {
+    return sequence_numbers.size();
+  }
+
+  bool empty() const
+  {
+    return sequence_numbers.empty();
+  }
+
+protected:
+  std::size_t next_sequence_number;
+  std::unordered_map<const statet *, std::size_t> sequence_numbers;
+
+  virtual void add(queuet::iterator, std::size_t sequence_number)=0;
+  virtual queuet::iterator pick()=0;
+  virtual void remove(queuet::iterator, std::size_t sequence_number)=0;
+  virtual void clear_index()=0;
+};
+
+/// Creates the strategy with the given name ("dfs", "bfs",
+/// "random-path", "depth", "icnt", "locs", "topological"), or
+/// returns nullptr if there is none.
+std::unique_ptr<search_strategyt> new_search_strategy(
+  const std::string &name,
+  unsigned seed=0);
+
+/// DFS explores the most recent state, BFS the oldest one.
+class sequence_strategyt:public search_strategyt
+{
+public:
+  explicit sequence_strategyt(bool _newest_first):
+    newest_first(_newest_first)
+  {
+  }
+
+protected:
+  bool newest_first;
+
+  // the states by sequence number
+  typedef std::map<std::size_t, queuet::iterator> statest;
+  statest states;
+
+  void add(queuet::iterator, std::size_t sequence_number) override;
+  queuet::iterator pick() override;
+  void remove(queuet::iterator, std::size_t sequence_number) override;
+
+  bool picks_oldest() const override
+  {
+    return !newest_first;
+  }
+
+  void clear_index() override
+  {
+    states.clear();
+  }
+};
+
+/// Picks a state at random, with probability proportional to a
+/// weight that is computed when the state is pushed. The weights are
+/// kept in a Fenwick tree over the slots of the states, which makes
+/// both sampling and removal logarithmic. The same seed gives the
+/// same sequence of picks.
+class weighted_random_strategyt:public search_strategyt
+{
+public:
+  explicit weighted_random_strategyt(unsigned seed):
+    generator(seed),
+    removals_since_rebuild(0)
+  {
+  }
+
+protected:
+  std::mt19937 generator;
+
+  struct slott
+  {
+    queuet::iterator state;
+    double weight;
+    bool used;
+    std::size_t sequence_number;
+  };
+
+  std::vector<slott> slots;
+  std::vector<std::size_t> free_slots;
+
+  // the slot of a state, by sequence number
+  std::unordered_map<std::size_t, std::size_t> slot_map;
+
+  // the partial sums of the weights, 1-based
+  std::vector<double> tree;
+  std::size_t removals_since_rebuild;
+
+  virtual double weight(const statet &) const=0;
+
+  void add(queuet::iterator, std::size_t sequence_number) override;
+  queuet::iterator pick() override;
+  void remove(queuet::iterator, std::size_t sequence_number) override;
+  void clear_index() override;
+
+  void free_slot(std::size_t slot);
+  void add_weight(std::size_t slot, double delta);
+  double prefix_sum(std::size_t count) const;
+  std::size_t find_slot(double) const;
+  void rebuild();
+
+  // the lowest set bit
+  static std::size_t lowbit(std::size_t i)
+  {
+    return i&(~i+1);
+  }
+};
+
+/// Prefers shallow states: the weight of a state is inversely
+/// proportional to its depth.
+class depth_weighted_strategyt:public weighted_random_strategyt
+{
+public:
+  explicit depth_weighted_strategyt(unsigned seed):
+    weighted_random_strategyt(seed)
+  {
+  }
+
+protected:
+  double weight(const statet &) const override;
+};
+
+/// Groups the queued states by their PC, and explores a state at the
+/// location with the lowest score; ties are broken in favor of the
+/// most recent state. The score of a location can change during the
+/// search, which moves its states in the order.
+class location_strategyt:public search_strategyt
+{
+public:
+  void build(const goto_functionst &) override;
+
+protected:
+  cfg_distancet cfg_distance;
+
+  struct buckett
+  {
+    unsigned score;
+
+    // the states, by sequence number
+    std::map<std::size_t, queuet::iterator> states;
+  };
+
+  // by the dense number of the PC
+  typedef std::unordered_map<std::size_t, buckett> bucketst;
+  bucketst buckets;
+
+  // the locations with queued states, ordered by score
+  typedef std::set<std::pair<unsigned, std::size_t>> ordert;
+  ordert order;
+
+  virtual unsigned score(std::size_t nr) const=0;
+
+  // the score of the given location has changed
+  void update_score(std::size_t nr);
+
+  // the scores of all locations have changed
+  void update_scores();
+
+  void add(queuet::iterator, std::size_t sequence_number) override;
+  queuet::iterator pick() override;
+  void remove(queuet::iterator, std::size_t sequence_number) override;
+
+  void clear_index() override
+  {
+    buckets.clear();
+    order.clear();
+  }
+};
+
+/// Prefers the states at the locations that have been executed least
+/// often, in the style of KLEE's instruction-count heuristic.
+class min_instruction_count_strategyt:public location_strategyt
+{
+public:
+  void build(const goto_functionst &) override;
+  void visit(const loc_reft &) override;
+
+protected:
+  std::vector<unsigned> counts;
+
+  unsigned score(std::size_t nr) const override
+  {
+    return counts[nr];
+  }
+};
+
+/// Explores the states at the earlier locations first, in the order
+/// of the program text. Within a function, this lets the paths that
+/// split up reach a join point before any of them continues past it,
+/// which is what merging of states needs.
+class topological_strategyt:public location_strategyt
+{
+protected:
+  unsigned score(std::size_t nr) const override
+  {
+    return static_cast<unsigned>(nr);
+  }
+};
+
+/// The queue of states of a search. The states are stored in a
+/// std::list in the order in which they were pushed, the most recent
+/// one first, and the strategy picks among them. The queue keeps an
+/// estimate of the memory used by its states. The estimate of a state
+/// changes while it is queued, as it shares parts with other states,
+/// and hence, the one made when it was pushed is kept.
+class state_queuet
+{
+public:
+  typedef search_strategyt::statet statet;
+  typedef search_strategyt::queuet queuet;
+
+  state_queuet():memory(0)
+  {
+  }
+
+  void set_strategy(std::unique_ptr<search_strategyt> _strategy)
+  {
+    PRECONDITION(states.empty());
+    strategy=std::move(_strategy);
+  }
+
+  search_strategyt &get_strategy()
+  {
+    PRECONDITION(strategy!=nullptr);
+    return *strategy;
+  }
+
+  // Moves all states in 'src' into the queue. The first one
+  // counts as the most recent one.
+  void push(queuet &src)
+  {
+    while(!src.empty())
+    {
+      states.splice(states.begin(), src, std::prev(src.end()));
+      strategy->push(states.begin());
+      const std::size_t state_memory=states.front().estimate_memory();
+      estimates[&states.front()]=state_memory;
+      memory+=state_memory;
+    }
+
+    strategy->end_push();
+  }
+
+  // moves the state picked by the strategy into 'dest'
+  void pop(queuet &dest)
+  {
+    const queuet::iterator state=strategy->pop();
+    forget_estimate(state);
+    dest.splice(dest.end(), states, state);
+  }
+
+  // moves the state that has been queued for longest into 'dest'
+  void pop_oldest(queuet &dest)
+  {
+    PRECONDITION(!states.empty());
+    remove(std::prev(states.end()), dest);
+  }
+
+  // Moves the state that the strategy will need last, presumably,
+  // into 'dest'. This is the oldest one, or the most recent one
+  // when the strategy explores the oldest states first.
+  void pop_cold(queuet &dest)
+  {
+    PRECONDITION(!states.empty());
+    remove(strategy->picks_oldest()?states.begin():std::prev(states.end()),
+           dest);
+  }
+
+  // moves all states into 'dest'
+  void pop_all(queuet &dest)
+  {
+    strategy->clear();
+    estimates.clear();
+    memory=0;
+    dest.splice(dest.end(), states);
+  }
+
+  queuet::iterator erase(queuet::iterator state)
+  {
+    strategy->erase(state);
+    forget_estimate(state);
+    return states.erase(state);
+  }
+
+  void clear()
+  {
+    strategy->clear();
+    estimates.clear();
+    memory=0;
+    states.clear();
+  }
+
+  // the estimated number of bytes used by the states
+  std::size_t estimate_memory() const
+  {
+    return memory;
+  }
+
+  queuet::iterator begin()
+  {
+    return states.begin();
+  }
+
+  queuet::iterator end()
+  {
+    return states.end();
+  }
+
+  std::size_t size() const
+  {
+    return states.size();
+  }
+
+  bool empty() const
+  {
+    return states.empty();
+  }
+
+protected:
+  queuet states;
+  std::unique_ptr<search_strategyt> strategy;
+  std::size_t memory;
+
+  // the estimates of the memory of the states when they were pushed
+  std::unordered_map<const statet *, std::size_t> estimates;
+
+  void forget_estimate(queuet::iterator state)
+  {
+    const auto e_it=estimates.find(&*state);
+    PRECONDITION(e_it!=estimates.end());
+    memory-=e_it->second;
+    estimates.erase(e_it);
+  }
+
+  void remove(queuet::iterator state, queuet &dest)
+  {
+    strategy->erase(state);
+    forget_estimate(state);
+    dest.splice(dest.end(), states, state);
+  }
+};
+
+#endif // CPROVER_SYMEX_SEARCH_STRATEGY_H
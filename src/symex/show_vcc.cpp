@@ -11,6 +11,8 @@ Author: Daniel Kroening, kroening@kroening.com
 
 #include "path_search.h"
 
+#include <algorithm>
+
 #include <util/format_expr.h>
 
 void path_searcht::do_show_vcc(statet &state)
@@ -36,6 +38,35 @@ void path_searcht::do_show_vcc(statet &state)
 
   for(const auto &step_ref : steps)
   {
+    if(step_ref->is_merge())
+    {
+      // the assignments on the merged paths, without their guards
+      std::vector<path_symex_step_reft> side;
+
+      for(const auto &path : step_ref->merge->merged_paths)
+        for(path_symex_step_reft s=path; s!=step_ref->predecessor; --s)
+          side.push_back(s);
+
+      std::reverse(side.begin(), side.end());
+
+      for(const auto &s : side)
+        if(s->ssa_rhs().is_not_nil())
+        {
+          equal_exprt equality(s->ssa_lhs(), s->ssa_rhs());
+          out << faint << "{-" << count << "} " << reset
+              << format(equality) << '\n';
+          count++;
+        }
+
+      for(const auto &phi : step_ref->merge->phis)
+      {
+        equal_exprt equality(phi.ssa_lhs, phi.ssa_rhs);
+        out << faint << "{-" << count << "} " << reset
+            << format(equality) << '\n';
+        count++;
+      }
+    }
+
     if(step_ref->ssa_guard.is_not_nil() &&
        !step_ref->ssa_guard.is_true())
     {
@@ -44,9 +75,9 @@ void path_searcht::do_show_vcc(statet &state)
       count++;
     }
 
-    if(step_ref->ssa_rhs.is_not_nil())
+    if(step_ref->ssa_rhs().is_not_nil())
     {
-      equal_exprt equality(step_ref->ssa_lhs, step_ref->ssa_rhs);
+      equal_exprt equality(step_ref->ssa_lhs(), step_ref->ssa_rhs());
       out << faint << "{-" << count << "} " << reset
           << format(equality) << '\n';
       count++;
@@ -0,0 +1,213 @@
+/*******************************************************************\
+
+Module: Decision Procedures for Path-based Symbolic Execution
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Decision Procedures for Path-based Symbolic Execution
+
+#include "solver_factory.h"
+
+#include <iostream>
+#include <sstream>
+
+#include <util/run.h>
+#include <util/tempfile.h>
+#include <util/version.h>
+
+#include <solvers/refinement/bv_refinement.h>
+#include <solvers/sat/satcheck.h>
+
+/// An SMT2 solver that is run as a subprocess with a given command
+/// line, and that optionally writes the problems to a stream as well
+class smt2_subprocesst:public smt2_dect
+{
+public:
+  smt2_subprocesst(
+    const namespacet &_ns,
+    smt2_dect::solvert _solver,
+    const std::vector<std::string> &_command,
+    std::ostream *_problem_out,
+    message_handlert &_message_handler):
+    smt2_dect(
+      _ns, "symex", "Generated by Symex " CBMC_VERSION, "QF_AUFBV",
+      _solver, _message_handler),
+    command(_command),
+    problem_out(_problem_out)
+  {
+  }
+
+protected:
+  std::vector<std::string> command;
+  std::ostream *problem_out;
+
+  resultt dec_solve() override
+  {
+    temporary_filet problem_file("symex_smt2_problem_", ".smt2");
+    temporary_filet stdout_file("symex_smt2_stdout_", "");
+    temporary_filet stderr_file("symex_smt2_stderr_", "");
+
+    {
+      std::ofstream out(problem_file());
+      out << stringstream.str();
+      write_footer(out);
+    }
+
+    if(problem_out!=nullptr)
+    {
+      *problem_out << stringstream.str();
+      write_footer(*problem_out);
+      problem_out->flush();
+    }
+
+    std::vector<std::string> argv=command;
+    argv.push_back(problem_file());
+
+    const int result=
+      run(argv.front(), argv, "", stdout_file(), stderr_file());
+
+    if(result<0)
+    {
+      error() << "error running SMT2 solver `" << argv.front() << "'" << eom;
+      return resultt::D_ERROR;
+    }
+
+    std::ifstream in(stdout_file());
+    return read_result(in);
+  }
+};
+
+/// Exposes the last step of the conversion, which the decision
+/// procedure otherwise does as part of solving
+class split_bv_pointerst:public bv_pointerst
+{
+public:
+  using bv_pointerst::bv_pointerst;
+  using bv_pointerst::finish_eager_conversion;
+};
+
+void solver_factoryt::solvert::finish_conversion()
+{
+  PRECONDITION(bv_pointers_ptr!=nullptr);
+  static_cast<split_bv_pointerst &>(*bv_pointers_ptr).
+    finish_eager_conversion();
+}
+
+decision_proceduret::resultt solver_factoryt::solvert::solve_propositional()
+{
+  switch(prop().prop_solve())
+  {
+  case propt::resultt::P_SATISFIABLE:
+    return decision_proceduret::resultt::D_SATISFIABLE;
+  case propt::resultt::P_UNSATISFIABLE:
+    return decision_proceduret::resultt::D_UNSATISFIABLE;
+  case propt::resultt::P_ERROR:
+    return decision_proceduret::resultt::D_ERROR;
+  }
+
+  UNREACHABLE;
+}
+
+void solver_factoryt::set_smt2_command(const std::string &command)
+{
+  backend=backendt::SMT2;
+  smt2_solver=smt2_dect::solvert::GENERIC;
+  smt2_command.clear();
+
+  std::istringstream in(command);
+  std::string word;
+
+  while(in >> word)
+    smt2_command.push_back(word);
+}
+
+std::unique_ptr<solver_factoryt::solvert> solver_factoryt::operator()(
+  message_handlert &message_handler,
+  bool with_time_limit)
+{
+  std::unique_ptr<solvert> solver;
+
+  switch(backend)
+  {
+  case backendt::SAT: solver=get_sat(message_handler); break;
+  case backendt::REFINEMENT: solver=get_refinement(message_handler); break;
+  case backendt::SMT2: return get_smt2(message_handler);
+  }
+
+  if(with_time_limit && time_limit!=0)
+    solver->prop().set_time_limit_seconds(time_limit);
+
+  return solver;
+}
+
+std::unique_ptr<solver_factoryt::solvert> solver_factoryt::get_sat(
+  message_handlert &message_handler)
+{
+  std::unique_ptr<solvert> solver(new solvert());
+
+  // the simplifier would eliminate variables that
+  // later incremental queries refer to
+  solver->prop_ptr.reset(new satcheck_no_simplifiert(message_handler));
+
+  solver->bv_pointers_ptr=
+    new split_bv_pointerst(ns, *solver->prop_ptr, message_handler);
+  solver->decision_procedure_ptr.reset(solver->bv_pointers_ptr);
+
+  return solver;
+}
+
+std::unique_ptr<solver_factoryt::solvert> solver_factoryt::get_refinement(
+  message_handlert &message_handler)
+{
+  std::unique_ptr<solvert> solver(new solvert());
+
+  solver->prop_ptr.reset(new satcheck_no_simplifiert(message_handler));
+
+  bv_refinementt::infot info;
+  info.ns=&ns;
+  info.prop=solver->prop_ptr.get();
+  info.message_handler=&message_handler;
+
+  solver->bv_pointers_ptr=new bv_refinementt(info);
+  solver->decision_procedure_ptr.reset(solver->bv_pointers_ptr);
+
+  return solver;
+}
+
+std::unique_ptr<solver_factoryt::solvert> solver_factoryt::get_smt2(
+  message_handlert &message_handler)
+{
+  std::unique_ptr<solvert> solver(new solvert());
+
+  number_of_queries++;
+
+  // every query goes into a file of its own, as each is
+  // a complete SMT2 problem
+  std::ostream *problem_out=nullptr;
+
+  if(outfile=="-")
+    problem_out=&std::cout;
+  else if(!outfile.empty())
+  {
+    solver->outfile_ptr.reset(new std::ofstream(
+      outfile+"."+std::to_string(number_of_queries)));
+
+    if(!*solver->outfile_ptr)
+      throw "failed to open "+outfile+"."+std::to_string(number_of_queries);
+
+    problem_out=solver->outfile_ptr.get();
+  }
+
+  std::vector<std::string> command=smt2_command;
+
+  if(command.empty())
+    command={ "z3", "-smt2" };
+
+  solver->decision_procedure_ptr.reset(new smt2_subprocesst(
+    ns, smt2_solver, command, problem_out, message_handler));
+
+  return solver;
+}
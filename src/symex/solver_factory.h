@@ -0,0 +1,162 @@
+/*******************************************************************\
+
+Module: Decision Procedures for Path-based Symbolic Execution
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Decision Procedures for Path-based Symbolic Execution
+
+#ifndef CPROVER_SYMEX_SOLVER_FACTORY_H
+#define CPROVER_SYMEX_SOLVER_FACTORY_H
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <solvers/flattening/bv_pointers.h>
+#include <solvers/prop/prop.h>
+#include <solvers/smt2/smt2_dec.h>
+
+/// Creates the decision procedures for the queries of the search:
+/// SAT-based flattening, the default; bit-vector refinement, with
+/// --refine; or an SMT2 solver run as a subprocess, with --smt2.
+class solver_factoryt
+{
+public:
+  explicit solver_factoryt(const namespacet &_ns):
+    ns(_ns),
+    backend(backendt::SAT),
+    smt2_solver(smt2_dect::solvert::Z3),
+    time_limit(0),
+    number_of_queries(0)
+  {
+  }
+
+  void set_refine()
+  {
+    backend=backendt::REFINEMENT;
+  }
+
+  void set_smt2(smt2_dect::solvert _smt2_solver)
+  {
+    backend=backendt::SMT2;
+    smt2_solver=_smt2_solver;
+  }
+
+  // Runs the given command line with the name of the problem file
+  // appended, instead of one of the known SMT2 solvers.
+  void set_smt2_command(const std::string &command);
+
+  // A limit on the time of each call of the propositional solvers,
+  // in seconds; zero for none. The solver gives up with an error
+  // once it is reached.
+  void set_time_limit(unsigned seconds)
+  {
+    time_limit=seconds;
+  }
+
+  unsigned get_time_limit() const
+  {
+    return time_limit;
+  }
+
+  // tells whether a query that failed after the given time has
+  // reached the time limit, rather than failing for another reason
+  bool is_limit_reached(std::chrono::duration<double> solver_time) const
+  {
+    return time_limit!=0 && solver_time.count()>=time_limit;
+  }
+
+  // the SMT2 queries are also written to this file,
+  // with the SMT2 backend only
+  void set_outfile(const std::string &_outfile)
+  {
+    outfile=_outfile;
+  }
+
+  // The propositional backends can be used incrementally. The SMT2
+  // solvers are run afresh for every query, and are thus only given
+  // the constraints of the path.
+  bool is_incremental() const
+  {
+    return backend!=backendt::SMT2;
+  }
+
+  // With the SAT backend, the solving can be split up: the search
+  // converts the expressions, and the propositional problem is then
+  // solved elsewhere, see solver_poolt.
+  bool can_solve_propositionally() const
+  {
+    return backend==backendt::SAT;
+  }
+
+  /// A decision procedure, together with the objects it uses.
+  class solvert
+  {
+  public:
+    decision_proceduret &decision_procedure() const
+    {
+      return *decision_procedure_ptr;
+    }
+
+    // for the propositional backends only
+    bv_pointerst &bv_pointers() const
+    {
+      PRECONDITION(bv_pointers_ptr!=nullptr);
+      return *bv_pointers_ptr;
+    }
+
+    propt &prop() const
+    {
+      PRECONDITION(prop_ptr!=nullptr);
+      return *prop_ptr;
+    }
+
+    // Completes the conversion of the constraints to propositional
+    // logic. The problem is then solved by solve_propositional, which
+    // does not touch any expressions, and can thus run in a thread of
+    // its own. For the SAT backend only.
+    void finish_conversion();
+    decision_proceduret::resultt solve_propositional();
+
+  protected:
+    friend class solver_factoryt;
+
+    // in the order of construction
+    std::unique_ptr<propt> prop_ptr;
+    std::unique_ptr<std::ofstream> outfile_ptr;
+    std::unique_ptr<decision_proceduret> decision_procedure_ptr;
+    bv_pointerst *bv_pointers_ptr=nullptr;
+  };
+
+  // The time limit is implemented with a process-wide alarm, and is
+  // thus only set for the solvers of the search thread.
+  std::unique_ptr<solvert> operator()(
+    message_handlert &,
+    bool with_time_limit=true);
+
+protected:
+  const namespacet &ns;
+
+  enum class backendt { SAT, REFINEMENT, SMT2 };
+  backendt backend;
+
+  smt2_dect::solvert smt2_solver;
+  std::vector<std::string> smt2_command;
+  std::string outfile;
+  unsigned time_limit;
+
+  // for the names of the files with the SMT2 queries
+  std::size_t number_of_queries;
+
+  std::unique_ptr<solvert> get_sat(message_handlert &);
+  std::unique_ptr<solvert> get_refinement(message_handlert &);
+  std::unique_ptr<solvert> get_smt2(message_handlert &);
+};
+
+#endif // CPROVER_SYMEX_SOLVER_FACTORY_H
@@ -0,0 +1,95 @@
+/*******************************************************************\
+
+Module: Pool of Solver Threads
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Pool of Solver Threads
+
+#include "solver_pool.h"
+
+solver_poolt::solver_poolt(std::size_t number_of_threads):
+  number_of_jobs(0),
+  stop(false)
+{
+  PRECONDITION(number_of_threads>0);
+
+  threads.reserve(number_of_threads);
+
+  for(std::size_t i=0; i<number_of_threads; i++)
+    threads.push_back(std::thread(&solver_poolt::worker, this));
+}
+
+solver_poolt::~solver_poolt()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop=true;
+  }
+
+  job_queued.notify_all();
+
+  for(auto &t : threads)
+    t.join();
+
+  // the remaining jobs are destroyed by this thread
+}
+
+void solver_poolt::submit(job_ptrt job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.push_back(std::move(job));
+    number_of_jobs++;
+  }
+
+  job_queued.notify_one();
+}
+
+void solver_poolt::get_finished(std::vector<job_ptrt> &dest, bool wait)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  if(wait && number_of_jobs!=0)
+    job_finished.wait(lock, [this] { return !finished.empty(); });
+
+  for(auto &job : finished)
+    dest.push_back(std::move(job));
+
+  number_of_jobs-=finished.size();
+  finished.clear();
+}
+
+/// the loop run by a solver thread
+void solver_poolt::worker()
+{
+  while(true)
+  {
+    job_ptrt job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_queued.wait(lock, [this] { return stop || !queued.empty(); });
+
+      if(stop)
+        return;
+
+      job=std::move(queued.front());
+      queued.pop_front();
+    }
+
+    auto start=std::chrono::steady_clock::now();
+    job->result=job->solver->solve_propositional();
+    job->solver_time=std::chrono::steady_clock::now()-start;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished.push_back(std::move(job));
+    }
+
+    job_finished.notify_one();
+  }
+}
@@ -0,0 +1,79 @@
+/*******************************************************************\
+
+Module: Pool of Solver Threads
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Pool of Solver Threads
+
+#ifndef CPROVER_SYMEX_SOLVER_POOL_H
+#define CPROVER_SYMEX_SOLVER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <util/message.h>
+
+#include "solver_factory.h"
+
+/// Solves propositional problems in worker threads. The expressions
+/// are converted by the thread that submits a job, as ireps must not
+/// be shared between threads; the workers only run the SAT solver.
+/// The finished jobs are taken back by the submitting thread, which
+/// reads the models, and destroys the solvers.
+class solver_poolt
+{
+public:
+  struct jobt
+  {
+    std::size_t id;
+
+    // the solvers of the jobs must not write to a shared handler
+    null_message_handlert message_handler;
+    std::unique_ptr<solver_factoryt::solvert> solver;
+
+    decision_proceduret::resultt result;
+    std::chrono::duration<double> solver_time;
+  };
+
+  typedef std::unique_ptr<jobt> job_ptrt;
+
+  explicit solver_poolt(std::size_t number_of_threads);
+
+  // the jobs that are running are finished first
+  ~solver_poolt();
+
+  // the conversion of the solver of the job must be finished
+  void submit(job_ptrt job);
+
+  // Moves the finished jobs into 'dest'. If 'wait' is set, waits for
+  // a job to finish if none has.
+  void get_finished(std::vector<job_ptrt> &dest, bool wait);
+
+  // the number of jobs that are queued, running or finished
+  std::size_t size() const
+  {
+    return number_of_jobs;
+  }
+
+protected:
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable job_queued, job_finished;
+  std::deque<job_ptrt> queued, finished;
+  std::size_t number_of_jobs;
+  bool stop;
+
+  void worker();
+};
+
+#endif // CPROVER_SYMEX_SOLVER_POOL_H
@@ -0,0 +1,78 @@
+/*******************************************************************\
+
+Module: Queued States on Disk
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Queued States on Disk
+
+#include "spilled_states.h"
+
+#include <sstream>
+
+#include <path-symex/path_symex_error.h>
+
+void spilled_statest::push(const path_replayt &path)
+{
+  if(file==nullptr)
+  {
+    file=std::tmpfile();
+    if(file==nullptr)
+      throw path_symex_errort() << "failed to create file for states";
+  }
+
+  std::ostringstream out;
+  path.write(out);
+  const std::string data=out.str();
+
+  // the records are appended
+  recordt record;
+
+  if(std::fseek(file, 0, SEEK_END)!=0 ||
+     (record.offset=std::ftell(file))<0 ||
+     std::fwrite(data.data(), 1, data.size(), file)!=data.size())
+    throw path_symex_errort() << "failed to write states to file";
+
+  record.size=data.size();
+  records.push_back(record);
+}
+
+bool spilled_statest::pop(path_replayt &path, bool lifo)
+{
+  if(records.empty())
+    return true;
+
+  const recordt record=lifo?records.back():records.front();
+
+  if(lifo)
+    records.pop_back();
+  else
+    records.pop_front();
+
+  std::string data(record.size, ' ');
+
+  if(std::fseek(file, record.offset, SEEK_SET)!=0 ||
+     std::fread(&data[0], 1, record.size, file)!=record.size)
+    return true;
+
+  // all read? then start over with an empty file
+  if(records.empty())
+    clear();
+
+  std::istringstream in(data);
+  return path.read(in);
+}
+
+void spilled_statest::clear()
+{
+  records.clear();
+
+  if(file!=nullptr)
+  {
+    std::fclose(file);
+    file=nullptr;
+  }
+}
@@ -0,0 +1,77 @@
+/*******************************************************************\
+
+Module: Queued States on Disk
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Queued States on Disk
+
+#ifndef CPROVER_SYMEX_SPILLED_STATES_H
+#define CPROVER_SYMEX_SPILLED_STATES_H
+
+#include <cstdio>
+#include <deque>
+#include <utility>
+
+#include <path-symex/path_replay.h>
+
+/// Queued states that have been moved out of memory. A state is
+/// stored as its path_replayt, i.e., mostly as its branch decisions,
+/// in a temporary file, and is rebuilt by replaying the path.
+class spilled_statest
+{
+public:
+  spilled_statest():file(nullptr)
+  {
+  }
+
+  ~spilled_statest()
+  {
+    clear();
+  }
+
+  spilled_statest(const spilled_statest &)=delete;
+  spilled_statest &operator=(const spilled_statest &)=delete;
+
+  void push(const path_replayt &);
+
+  // Takes the path pushed most recently, or the one pushed
+  // least recently if 'lifo' is not set. Returns true on error.
+  bool pop(path_replayt &, bool lifo);
+
+  std::size_t size() const
+  {
+    return records.size();
+  }
+
+  bool empty() const
+  {
+    return records.empty();
+  }
+
+  // discards all paths, and closes the file
+  void clear();
+
+  void swap(spilled_statest &other)
+  {
+    std::swap(file, other.file);
+    records.swap(other.records);
+  }
+
+protected:
+  std::FILE *file;
+
+  // the offsets and sizes of the records in the file
+  struct recordt
+  {
+    long offset;
+    std::size_t size;
+  };
+
+  std::deque<recordt> records;
+};
+
+#endif // CPROVER_SYMEX_SPILLED_STATES_H
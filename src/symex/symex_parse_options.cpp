@@ -232,6 +232,33 @@ int symex_parse_optionst::doit()
       path_search.set_time_limit(
         safe_string2unsigned(cmdline.get_value("max-search-time")));
 
+    if(cmdline.isset("fork-workers"))
+      path_search.set_fork_workers(
+        safe_string2unsigned(cmdline.get_value("fork-workers")));
+
+    if(cmdline.isset("solver-threads"))
+      path_search.set_solver_threads(
+        safe_string2unsigned(cmdline.get_value("solver-threads")));
+
+    if(cmdline.isset("solver-time-limit"))
+      path_search.solver_factory.set_time_limit(
+        safe_string2unsigned(cmdline.get_value("solver-time-limit")));
+
+    path_search.retry_unknown=cmdline.isset("retry-unknown");
+
+    if(cmdline.isset("query-cache"))
+      path_search.set_query_cache_directory(cmdline.get_value("query-cache"));
+
+    if(cmdline.isset("iterative-deepening"))
+      path_search.set_iterative_deepening(
+        safe_string2unsigned(cmdline.get_value("iterative-deepening")),
+        cmdline.isset("deepening-factor")?
+          safe_string2unsigned(cmdline.get_value("deepening-factor")):2);
+
+    if(cmdline.isset("queue-memory"))
+      path_search.set_queue_memory_limit(
+        safe_string2unsigned(cmdline.get_value("queue-memory")));
+
     if(cmdline.isset("dfs"))
       path_search.set_dfs();
 
@@ -241,6 +268,70 @@ int symex_parse_optionst::doit()
     if(cmdline.isset("locs"))
       path_search.set_locs();
 
+    if(cmdline.isset("random-path"))
+      path_search.set_random_path();
+
+    if(cmdline.isset("seed"))
+      path_search.set_seed(
+        safe_string2unsigned(cmdline.get_value("seed")));
+
+    for(const auto &target : cmdline.get_values("target-line"))
+    {
+      // file:line
+      const std::size_t colon=target.rfind(':');
+
+      if(colon==std::string::npos || colon==0)
+      {
+        error() << "--target-line expects file:line" << eom;
+        return 1;
+      }
+
+      path_search.add_target_line(
+        target.substr(0, colon),
+        safe_string2unsigned(target.substr(colon+1)));
+    }
+
+    for(const auto &target : cmdline.get_values("target-property"))
+      path_search.add_target_property(target);
+
+    if(cmdline.isset("merge-states"))
+      path_search.set_merge_states(
+        cmdline.isset("merge-limit")?
+          safe_string2unsigned(cmdline.get_value("merge-limit")):8);
+
+    path_search.drop_duplicate_states=
+      cmdline.isset("drop-duplicate-states");
+
+    if(cmdline.isset("refine"))
+      path_search.solver_factory.set_refine();
+
+    if(cmdline.isset("smt2") || cmdline.isset("z3"))
+      path_search.solver_factory.set_smt2(smt2_dect::solvert::Z3);
+
+    if(cmdline.isset("smt2-solver"))
+      path_search.solver_factory.set_smt2_command(
+        cmdline.get_value("smt2-solver"));
+
+    if(cmdline.isset("outfile"))
+    {
+      if(!cmdline.isset("smt2") && !cmdline.isset("z3") &&
+         !cmdline.isset("smt2-solver"))
+      {
+        error() << "--outfile requires --smt2, --z3 or --smt2-solver" << eom;
+        return 1;
+      }
+
+      path_search.solver_factory.set_outfile(cmdline.get_value("outfile"));
+    }
+
+    if(cmdline.isset("search") &&
+       path_search.set_search_strategy(cmdline.get_value("search")))
+    {
+      error() << "unknown search strategy `"
+              << cmdline.get_value("search") << "'" << eom;
+      return 1;
+    }
+
     if(cmdline.isset("show-vcc"))
     {
       path_search.show_vcc=true;
@@ -254,6 +345,9 @@ int symex_parse_optionst::doit()
     path_search.stop_on_fail=
       cmdline.isset("stop-on-fail");
 
+    // most coverage goals are satisfiable
+    path_search.multi_goal=cmdline.isset("cover");
+
     if(cmdline.isset("cover"))
     {
       // test-suite generation
@@ -268,6 +362,14 @@ int symex_parse_optionst::doit()
       {
       case safety_checkert::resultt::SAFE:
         report_properties(path_search.property_map);
+
+        for(const auto &p : path_search.property_map)
+          if(p.second.is_unknown())
+          {
+            result() << bold << "VERIFICATION INCONCLUSIVE" << reset << eom;
+            return 5;
+          }
+
         report_success();
         return 0;
 
@@ -440,6 +542,7 @@ void symex_parse_optionst::report_properties(
       case path_searcht::SUCCESS: status_string="SUCCESS"; break;
       case path_searcht::FAILURE: status_string="FAILURE"; break;
       case path_searcht::NOT_REACHED: status_string="SUCCESS"; break;
+      case path_searcht::UNKNOWN: status_string="UNKNOWN"; break;
       }
 
       xml_result.set_attribute("status", status_string);
@@ -457,6 +560,7 @@ void symex_parse_optionst::report_properties(
       case path_searcht::SUCCESS: result() << green << "SUCCESS" << reset; break;
       case path_searcht::FAILURE: result() << red << "FAILURE" << reset; break;
       case path_searcht::NOT_REACHED: result() << yellow << "SUCCESS" << reset << " (not reached)"; break;
+      case path_searcht::UNKNOWN: result() << yellow << "UNKNOWN" << reset; break;
       }
       result() << eom;
     }
@@ -661,10 +765,36 @@ void symex_parse_optionst::help()
     " --context-bound nr           limit number of context switches\n"
     " --branch-bound nr            limit number of branches taken\n"
     " --max-search-time s          limit search to approximately s seconds\n"
+    " --iterative-deepening d      search up to depth d, then d*k, d*k*k, ...\n" // NOLINT(*)
+    " --deepening-factor k         the factor k for iterative deepening (default: 2)\n" // NOLINT(*)
     " --dfs                        use depth first search\n"
     " --bfs                        use breadth first search\n"
+    " --locs                       prefer paths closest to unvisited locations\n" // NOLINT(*)
+    " --random-path                pick paths by random walks in the execution tree\n" // NOLINT(*)
+    " --seed s                     seed for the random search strategies\n"
+    " --search s                   use search strategy s: dfs, bfs, locs,\n"
+    "                              random-path, depth, icnt, topological\n"
+    " --target-line file:line      prefer paths closest to the given line\n"
+    " --target-property id         prefer paths closest to the given property\n" // NOLINT(*)
+    " --merge-states               merge the paths that meet at join points\n" // NOLINT(*)
+    " --merge-limit n              merge only if at most n variables differ (default: 8)\n" // NOLINT(*)
+    " --drop-duplicate-states      drop states that have been explored before\n" // NOLINT(*)
+    " --fork-workers n             explore paths using n worker processes\n"
+    " --solver-threads n           solve queries in n threads while exploring\n" // NOLINT(*)
+    " --queue-memory MB            move queued states to disk beyond MB megabytes\n" // NOLINT(*)
     " --eager-infeasibility        query solver early to determine whether a path is infeasible before searching it\n" // NOLINT(*)
     "\n"
+    "Backend options:\n"
+    " --refine                     use bit-vector refinement\n"
+    " --smt2                       use default SMT2 solver (Z3)\n"
+    " --z3                         use Z3\n"
+    " --smt2-solver cmd            use the SMT2 solver run by cmd, given the file\n" // NOLINT(*)
+    " --outfile filename           with an SMT2 solver, also write the queries to filename.1, ...\n" // NOLINT(*)
+    " --solver-time-limit s        give up on a SAT query after s seconds\n" // NOLINT(*)
+    " --retry-unknown              retry states whose feasibility is unknown\n" // NOLINT(*)
+    "                              with a larger time limit\n"
+    " --query-cache dir            keep the solver results in dir for later runs\n" // NOLINT(*)
+    "\n"
     "Other options:\n"
     " --version                    show version and exit\n"
     " --xml-ui                     use XML-formatted output\n"
@@ -31,6 +31,9 @@ class optionst;
   OPT_FUNCTIONS \
   "D:I:" \
   "(depth):(context-bound):(branch-bound):(unwind):(max-search-time):" \
+  "(fork-workers):(solver-threads):(queue-memory):" \
+  "(solver-time-limit):(retry-unknown)(query-cache):" \
+  "(iterative-deepening):(deepening-factor):" \
   OPT_GOTO_CHECK \
   "(no-assertions)(no-assumptions)" \
   "(unwinding-assertions)" \
@@ -39,12 +42,14 @@ class optionst;
   "(little-endian)(big-endian)" \
   "(error-label):(verbosity):(no-library)" \
   "(version)" \
-  "(bfs)(dfs)(locs)" \
+  "(bfs)(dfs)(locs)(random-path)(seed):(search):" \
+  "(target-line):(target-property):" \
+  "(merge-states)(merge-limit):(drop-duplicate-states)" \
   "(cover):" \
   "(i386-linux)(i386-macos)(i386-win32)(win32)(winx64)(gcc)" \
   "(c89)(c99)(c11)" \
   "(ppc-macos)(unsigned-char)" \
-  "(string-abstraction)(smt2)(z3)(refine)(outfile):" \
+  "(string-abstraction)(smt2)(z3)(refine)(outfile):(smt2-solver):" \
   "(no-arch)(arch):(floatbv)(fixedbv)" \
   "(round-to-nearest)(round-to-plus-inf)(round-to-minus-inf)(round-to-zero)" \
   "(show-locs)(show-vcc)(show-loops)(show-properties)(show-symbol-table)" \
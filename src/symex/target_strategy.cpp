@@ -0,0 +1,69 @@
+/*******************************************************************\
+
+Module: Directed Search towards Target Locations
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Directed Search towards Target Locations
+
+#include "target_strategy.h"
+
+#include <util/string2int.h>
+
+void target_strategyt::build(const goto_functionst &goto_functions)
+{
+  location_strategyt::build(goto_functions);
+
+  std::vector<bool> targets(cfg_distance.size(), false);
+  number_of_targets=0;
+
+  for(std::size_t nr=0; nr<targets.size(); nr++)
+    if(is_target(*cfg_distance.get_loc(nr).target))
+    {
+      targets[nr]=true;
+      number_of_targets++;
+    }
+
+  cfg_distance.compute(targets);
+}
+
+bool target_strategyt::is_target(
+  const goto_programt::instructiont &instruction) const
+{
+  const source_locationt &source_location=instruction.source_location;
+
+  if(instruction.is_assert() &&
+     target_properties.find(source_location.get_property_id())!=
+       target_properties.end())
+    return true;
+
+  if(target_lines.empty() || source_location.get_line().empty())
+    return false;
+
+  const std::string &file=id2string(source_location.get_file());
+  const unsigned line=unsafe_string2unsigned(
+    id2string(source_location.get_line()));
+
+  for(const auto &t : target_lines)
+  {
+    if(t.second!=line)
+      continue;
+
+    if(file==t.first)
+      return true;
+
+    // a suffix after a directory separator
+    if(file.size()>t.first.size() &&
+       file.compare(file.size()-t.first.size(), t.first.size(), t.first)==0)
+    {
+      const char separator=file[file.size()-t.first.size()-1];
+      if(separator=='/' || separator=='\\')
+        return true;
+    }
+  }
+
+  return false;
+}
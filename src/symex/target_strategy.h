@@ -0,0 +1,65 @@
+/*******************************************************************\
+
+Module: Directed Search towards Target Locations
+
+Author: Daniel Kroening, kroening@kroening.com
+
+\*******************************************************************/
+
+/// \file
+/// Directed Search towards Target Locations
+
+#ifndef CPROVER_SYMEX_TARGET_STRATEGY_H
+#define CPROVER_SYMEX_TARGET_STRATEGY_H
+
+#include <set>
+#include <string>
+
+#include "search_strategy.h"
+
+/// Prefers the states closest to one of the target locations, by the
+/// number of instructions on the shortest path in the interprocedural
+/// CFG. The targets are the instructions with a given source line or
+/// the assertions with a given property ID. The distances are
+/// computed once, before the search.
+class target_strategyt:public location_strategyt
+{
+public:
+  target_strategyt():number_of_targets(0)
+  {
+  }
+
+  // the file matches if it is given in full or as a suffix
+  // following a directory separator
+  void add_target_line(const std::string &file, unsigned line)
+  {
+    target_lines.insert(std::make_pair(file, line));
+  }
+
+  void add_target_property(const irep_idt &property)
+  {
+    target_properties.insert(property);
+  }
+
+  void build(const goto_functionst &) override;
+
+  // the number of instructions found to be targets
+  std::size_t get_number_of_targets() const
+  {
+    return number_of_targets;
+  }
+
+protected:
+  std::set<std::pair<std::string, unsigned>> target_lines;
+  std::set<irep_idt> target_properties;
+  std::size_t number_of_targets;
+
+  bool is_target(const goto_programt::instructiont &) const;
+
+  unsigned score(std::size_t nr) const override
+  {
+    return cfg_distance.distance(nr);
+  }
+};
+
+#endif // CPROVER_SYMEX_TARGET_STRATEGY_H